@@ -0,0 +1,106 @@
+#include "gdwg/graph.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	// A node below num_nodes, from the engine's raw output so every compiler draws the same.
+	auto draw_node(std::mt19937& engine, int num_nodes) -> int {
+		return static_cast<int>(engine() % static_cast<std::uint32_t>(num_nodes));
+	}
+
+	// Each node has edges_per_node edges to random nodes.
+	auto make_graph(int num_nodes, int edges_per_node) -> graph_t {
+		auto engine = std::mt19937(1);
+		auto edges = std::vector<graph_t::value_type>{};
+		for (auto i = 0; i < num_nodes; i++) {
+			for (auto j = 0; j < edges_per_node; j++) {
+				auto const to = draw_node(engine, num_nodes);
+				edges.push_back({i, to, j});
+			}
+		}
+		return graph_t(edges);
+	}
+
+	// A batch of state.range(1) edges, each between two random nodes of a graph of
+	// state.range(0) nodes, which is put back as it was between iterations.
+	auto insert_small_batch(benchmark::State& state) -> void {
+		auto const num_nodes = static_cast<int>(state.range(0));
+		auto g = make_graph(num_nodes, 1);
+		auto engine = std::mt19937(2);
+		auto batch = std::vector<graph_t::value_type>{};
+		for (auto i = 0; i < state.range(1); i++) {
+			auto const from = draw_node(engine, num_nodes);
+			auto const to = draw_node(engine, num_nodes);
+			batch.push_back({from, to, -1 - i});
+		}
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(g.insert_edges(batch));
+			state.PauseTiming();
+			for (auto const& [from, to, weight] : batch) {
+				g.erase_edge(from, to, weight);
+			}
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(1));
+	}
+
+	// Erases one node with an edge each way from a graph of state.range(0) nodes, and puts it
+	// back between iterations.
+	auto erase_one_node(benchmark::State& state) -> void {
+		auto const num_nodes = static_cast<int>(state.range(0));
+		auto g = make_graph(num_nodes, 1);
+		auto const victim = num_nodes;
+		for (auto _ : state) {
+			state.PauseTiming();
+			g.insert_node(victim);
+			g.insert_edge(victim, 0, 0);
+			g.insert_edge(0, victim, 0);
+			state.ResumeTiming();
+			benchmark::DoNotOptimize(g.erase_nodes(std::vector<int>{victim}));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	// Renames one node of a graph of state.range(0) nodes to a new value and back again.
+	auto relabel_one_node(benchmark::State& state) -> void {
+		auto const num_nodes = static_cast<int>(state.range(0));
+		auto g = make_graph(num_nodes, 1);
+		auto const node = num_nodes / 2;
+		auto const there = std::vector<std::pair<int, int>>{{node, -1}};
+		auto const back = std::vector<std::pair<int, int>>{{-1, node}};
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(g.relabel(there));
+			benchmark::DoNotOptimize(g.relabel(back));
+		}
+		state.SetItemsProcessed(2 * state.iterations());
+	}
+
+	// Merges a node with an edge each way into another node of a graph of state.range(0) nodes,
+	// and puts it back between iterations.
+	auto merge_one_pair(benchmark::State& state) -> void {
+		auto const num_nodes = static_cast<int>(state.range(0));
+		auto g = make_graph(num_nodes, 1);
+		auto const merged = num_nodes;
+		auto const pairs = std::vector<std::pair<int, int>>{{merged, 0}};
+		for (auto _ : state) {
+			state.PauseTiming();
+			g.insert_node(merged);
+			g.insert_edge(merged, 1, merged);
+			g.insert_edge(1, merged, merged);
+			state.ResumeTiming();
+			benchmark::DoNotOptimize(g.merge_replace_nodes(pairs));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+} // namespace
+
+BENCHMARK(insert_small_batch)->Args({500'000, 1})->Args({500'000, 1'000});
+BENCHMARK(erase_one_node)->Arg(500'000);
+BENCHMARK(relabel_one_node)->Arg(500'000);
+BENCHMARK(merge_one_pair)->Arg(500'000);
@@ -0,0 +1,87 @@
+#include "gdwg/graph.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+	// Nodes are long enough to defeat the small string optimisation, so that copying one costs
+	// an allocation.
+	auto make_graph(int num_nodes, int edges_per_node) -> gdwg::graph<std::string, int> {
+		auto names = std::vector<std::string>{};
+		for (auto i = 0; i < num_nodes; i++) {
+			names.push_back("node name number " + std::to_string(i));
+		}
+		auto g = gdwg::graph<std::string, int>(names.begin(), names.end());
+		for (auto i = 0; i < num_nodes; i++) {
+			for (auto j = 0; j < edges_per_node; j++) {
+				g.insert_edge(names[static_cast<std::size_t>(i)],
+				              names[static_cast<std::size_t>((i * 31 + j * 17) % num_nodes)],
+				              j);
+			}
+		}
+		return g;
+	}
+
+	auto range_for(benchmark::State& state) -> void {
+		auto const g = make_graph(static_cast<int>(state.range(0)), 16);
+		for (auto _ : state) {
+			auto total = std::size_t{0};
+			for (auto const& [from, to, weight] : g) {
+				total += from.size() + to.size() + static_cast<std::size_t>(weight);
+			}
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+
+	auto for_each_edge(benchmark::State& state) -> void {
+		auto const g = make_graph(static_cast<int>(state.range(0)), 16);
+		for (auto _ : state) {
+			auto total = std::size_t{0};
+			g.for_each_edge([&](std::string const& from, std::string const& to, int weight) {
+				total += from.size() + to.size() + static_cast<std::size_t>(weight);
+			});
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+
+	auto weights_of_each_node(benchmark::State& state) -> void {
+		auto const g = make_graph(static_cast<int>(state.range(0)), 16);
+		auto const nodes = g.nodes();
+		for (auto _ : state) {
+			auto total = std::size_t{0};
+			for (auto const& node : nodes) {
+				for (auto const& to : g.connections(node)) {
+					for (auto const weight : g.weights(node, to)) {
+						total += to.size() + static_cast<std::size_t>(weight);
+					}
+				}
+			}
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+
+	auto for_each_out_edge(benchmark::State& state) -> void {
+		auto const g = make_graph(static_cast<int>(state.range(0)), 16);
+		auto const nodes = g.nodes();
+		for (auto _ : state) {
+			auto total = std::size_t{0};
+			for (auto const& node : nodes) {
+				g.for_each_out_edge(node, [&](std::string const& to, int weight) {
+					total += to.size() + static_cast<std::size_t>(weight);
+				});
+			}
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+} // namespace
+
+BENCHMARK(range_for)->Arg(1'000)->Arg(10'000);
+BENCHMARK(for_each_edge)->Arg(1'000)->Arg(10'000);
+BENCHMARK(weights_of_each_node)->Arg(1'000)->Arg(10'000);
+BENCHMARK(for_each_out_edge)->Arg(1'000)->Arg(10'000);
@@ -0,0 +1,152 @@
+#include "gdwg/shortest_paths.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+	// A number from low to high. mt19937's output is fixed by the standard but the
+	// distributions' algorithms are not, so this keeps the graphs the same on every compiler.
+	auto draw(std::mt19937& engine, int low, int high) -> int {
+		return low + static_cast<int>(engine() % static_cast<std::uint32_t>(high - low + 1));
+	}
+
+	// Each node has edges_per_node edges to random nodes, with weights between 1 and 1000.
+	// Every number is drawn in its own statement, so the draws happen in a fixed order.
+	auto make_random_graph(int num_nodes, int edges_per_node) -> gdwg::graph<int, int> {
+		auto engine = std::mt19937(1);
+		auto g = gdwg::graph<int, int>();
+		for (auto i = 0; i < num_nodes; i++) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < num_nodes; i++) {
+			for (auto j = 0; j < edges_per_node; j++) {
+				auto const to = draw(engine, 0, num_nodes - 1);
+				auto const weight = draw(engine, 1, 1000);
+				g.insert_edge(i, to, weight);
+			}
+		}
+		return g;
+	}
+
+	// A side by side grid with edges both ways between neighbours, whose small weights give
+	// many equal distances and many decreased keys.
+	auto make_grid_graph(int side) -> gdwg::graph<int, int> {
+		auto engine = std::mt19937(1);
+		auto weight_dist = std::uniform_int_distribution<int>(1, 10);
+		auto g = gdwg::graph<int, int>();
+		for (auto i = 0; i < side * side; i++) {
+			g.insert_node(i);
+		}
+		for (auto row = 0; row < side; row++) {
+			for (auto col = 0; col < side; col++) {
+				auto const node = row * side + col;
+				if (col + 1 < side) {
+					g.insert_edge(node, node + 1, weight_dist(engine));
+					g.insert_edge(node + 1, node, weight_dist(engine));
+				}
+				if (row + 1 < side) {
+					g.insert_edge(node, node + side, weight_dist(engine));
+					g.insert_edge(node + side, node, weight_dist(engine));
+				}
+			}
+		}
+		return g;
+	}
+
+	// What a caller without shortest_paths would write on top of connections and weights.
+	auto hand_written_dijkstra(gdwg::graph<int, int> const& g, int src) -> std::map<int, int> {
+		auto distances = std::map<int, int>{{src, 0}};
+		using item = std::pair<int, int>;
+		auto queue = std::priority_queue<item, std::vector<item>, std::greater<>>();
+		queue.emplace(0, src);
+		while (!queue.empty()) {
+			auto const [distance, node] = queue.top();
+			queue.pop();
+			if (distance > distances[node]) {
+				continue;
+			}
+			for (auto const& to : g.connections(node)) {
+				auto const candidate = distance + g.weights(node, to).front();
+				auto const [search, inserted] = distances.emplace(to, candidate);
+				if (inserted || candidate < search->second) {
+					search->second = candidate;
+					queue.emplace(candidate, to);
+				}
+			}
+		}
+		return distances;
+	}
+
+	auto hand_written(benchmark::State& state) -> void {
+		auto const g = make_random_graph(static_cast<int>(state.range(0)), 8);
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(hand_written_dijkstra(g, 0));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+
+	template<typename Heap>
+	auto random_graph(benchmark::State& state) -> void {
+		auto const g = make_random_graph(static_cast<int>(state.range(0)), 8);
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::shortest_paths<Heap>(g, 0));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.num_edges()));
+	}
+
+	template<typename Heap>
+	auto random_csr_graph(benchmark::State& state) -> void {
+		auto const g = make_random_graph(static_cast<int>(state.range(0)), 8).freeze();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::shortest_paths<Heap>(g, 0));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(state.range(0)) * 8);
+	}
+
+	template<typename Heap>
+	auto grid_csr_graph(benchmark::State& state) -> void {
+		auto const side = static_cast<int>(state.range(0));
+		auto const g = make_grid_graph(side).freeze();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::shortest_paths<Heap>(g, 0));
+		}
+		state.SetItemsProcessed(state.iterations() * side * side);
+	}
+
+	template<typename Heap>
+	auto random_csr_graph_to_target(benchmark::State& state) -> void {
+		auto const num_nodes = static_cast<int>(state.range(0));
+		auto const g = make_random_graph(num_nodes, 8).freeze();
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::shortest_paths<Heap>(g, 0, num_nodes / 2));
+		}
+	}
+} // namespace
+
+BENCHMARK(hand_written)->Arg(10'000)->Arg(100'000);
+
+BENCHMARK_TEMPLATE(random_graph, gdwg::binary_heap)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_graph, gdwg::dary_heap<4>)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_graph, gdwg::radix_heap)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_graph, gdwg::pairing_heap)->Arg(10'000)->Arg(100'000);
+
+BENCHMARK_TEMPLATE(random_csr_graph, gdwg::binary_heap)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_csr_graph, gdwg::dary_heap<4>)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_csr_graph, gdwg::dary_heap<8>)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_csr_graph, gdwg::radix_heap)->Arg(10'000)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_csr_graph, gdwg::pairing_heap)->Arg(10'000)->Arg(100'000);
+
+BENCHMARK_TEMPLATE(grid_csr_graph, gdwg::binary_heap)->Arg(100)->Arg(300);
+BENCHMARK_TEMPLATE(grid_csr_graph, gdwg::dary_heap<4>)->Arg(100)->Arg(300);
+BENCHMARK_TEMPLATE(grid_csr_graph, gdwg::radix_heap)->Arg(100)->Arg(300);
+BENCHMARK_TEMPLATE(grid_csr_graph, gdwg::pairing_heap)->Arg(100)->Arg(300);
+
+BENCHMARK_TEMPLATE(random_csr_graph_to_target, gdwg::dary_heap<4>)->Arg(100'000);
+BENCHMARK_TEMPLATE(random_csr_graph_to_target, gdwg::radix_heap)->Arg(100'000);
@@ -0,0 +1,279 @@
+#ifndef GDWG_CSR_GRAPH_HPP
+#define GDWG_CSR_GRAPH_HPP
+
+#include "gdwg/lookup_key.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	namespace detail {
+		// Specialised by algorithms such as gdwg::shortest_paths to walk a graph's own containers.
+		template<typename G>
+		struct adjacency_access;
+	} // namespace detail
+
+	// Immutable compressed sparse row snapshot of a gdwg::graph, usually built by graph::freeze().
+	// Node i is nodes_[i] (sorted ascending) and its edges are the index range
+	// [offsets_[i], offsets_[i + 1]) of dsts_ and weights_, sorted by destination then weight.
+	template<typename N, typename E>
+	class csr_graph {
+	private:
+		class iterator;
+
+	public:
+		using iterator = iterator;
+		using const_iterator = iterator;
+		using node_id = std::uint32_t;
+		struct value_type {
+			N from;
+			N to;
+			E weight;
+		};
+
+		csr_graph() = default;
+		csr_graph(std::vector<N> nodes,
+		          std::vector<std::size_t> offsets,
+		          std::vector<node_id> dsts,
+		          std::vector<E> weights);
+
+		// As in gdwg::graph, node parameters accept any detail::lookup_key<N>.
+		template<detail::lookup_key<N> K = N>
+		auto is_node(K const& value) const -> bool;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto is_connected(S const& src, D const& dst) const -> bool;
+		auto nodes() const noexcept -> std::vector<N>;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto weights(S const& src, D const& dst) const -> std::vector<E>;
+		template<detail::lookup_key<N> K = N>
+		auto connections(K const& src) const -> std::vector<N>;
+		auto operator==(csr_graph<N, E> const& other) const -> bool = default;
+		auto begin() const noexcept -> iterator;
+		auto end() const noexcept -> iterator;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto find(S const& src, D const& dst, E const& weight) const -> iterator;
+		friend auto operator<<(std::ostream& os, csr_graph<N, E> const& g) -> std::ostream& {
+			for (auto i = std::size_t{0}; i < g.nodes_.size(); i++) {
+				os << g.nodes_[i] << " (\n";
+				for (auto e = g.offsets_[i]; e < g.offsets_[i + 1]; e++) {
+					os << "  " << g.nodes_[g.dsts_[e]] << " | " << g.weights_[e] << "\n";
+				}
+				os << ")\n";
+			}
+			return os;
+		}
+
+	private:
+		template<typename G>
+		friend struct detail::adjacency_access;
+
+		std::vector<N> nodes_;
+		std::vector<std::size_t> offsets_ = std::vector<std::size_t>(1);
+		std::vector<node_id> dsts_;
+		std::vector<E> weights_;
+
+		template<typename K>
+		auto index_of(K const& value) const -> std::size_t;
+		auto dst_range(std::size_t src, std::size_t dst) const -> std::pair<std::size_t, std::size_t>;
+
+		class iterator {
+		public:
+			using value_type = csr_graph<N, E>::value_type;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			iterator() = default;
+
+			auto operator*() const -> reference {
+				return value_type{graph_->nodes_[src_],
+				                  graph_->nodes_[graph_->dsts_[edge_]],
+				                  graph_->weights_[edge_]};
+			}
+
+			auto operator++() -> iterator& {
+				edge_++;
+				while (src_ < graph_->nodes_.size() && graph_->offsets_[src_ + 1] <= edge_) {
+					src_++;
+				}
+				return *this;
+			}
+			auto operator++(int) -> iterator {
+				auto before_iterator = *this;
+				++*this;
+				return before_iterator;
+			}
+			auto operator--() -> iterator& {
+				edge_--;
+				while (graph_->offsets_[src_] > edge_) {
+					src_--;
+				}
+				return *this;
+			}
+			auto operator--(int) -> iterator {
+				auto before_iterator = *this;
+				--*this;
+				return before_iterator;
+			}
+
+			auto operator==(iterator const& other) const -> bool {
+				return (graph_ == other.graph_ && edge_ == other.edge_);
+			}
+
+		private:
+			friend class csr_graph<N, E>;
+			csr_graph<N, E> const* graph_ = nullptr;
+			std::size_t src_ = 0;
+			std::size_t edge_ = 0;
+
+			iterator(csr_graph<N, E> const& graph, std::size_t src, std::size_t edge)
+			: graph_(&graph)
+			, src_(src)
+			, edge_(edge) {}
+		};
+	};
+
+	template<typename N, typename E>
+	csr_graph<N, E>::csr_graph(std::vector<N> nodes,
+	                           std::vector<std::size_t> offsets,
+	                           std::vector<node_id> dsts,
+	                           std::vector<E> weights)
+	: nodes_(std::move(nodes))
+	, offsets_(std::move(offsets))
+	, dsts_(std::move(dsts))
+	, weights_(std::move(weights)) {
+		if (nodes_.size() > std::numeric_limits<node_id>::max()
+		    || offsets_.size() != nodes_.size() + 1 || offsets_.front() != 0
+		    || offsets_.back() != dsts_.size() || dsts_.size() != weights_.size())
+		{
+			throw std::invalid_argument("Cannot construct gdwg::csr_graph<N, E> from arrays with "
+			                            "inconsistent sizes");
+		}
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto csr_graph<N, E>::is_node(K const& value) const -> bool {
+		return index_of(value) != nodes_.size();
+	}
+
+	template<typename N, typename E>
+	[[nodiscard]] auto csr_graph<N, E>::empty() const noexcept -> bool {
+		return nodes_.empty();
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto csr_graph<N, E>::is_connected(S const& src, D const& dst) const -> bool {
+		auto const src_index = index_of(src);
+		auto const dst_index = index_of(dst);
+		if (src_index == nodes_.size() || dst_index == nodes_.size()) {
+			throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst "
+			                         "node don't exist in the graph");
+		}
+		auto const [first, last] = dst_range(src_index, dst_index);
+		return first != last;
+	}
+
+	template<typename N, typename E>
+	[[nodiscard]] auto csr_graph<N, E>::nodes() const noexcept -> std::vector<N> {
+		return nodes_;
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto csr_graph<N, E>::weights(S const& src, D const& dst) const -> std::vector<E> {
+		auto const src_index = index_of(src);
+		auto const dst_index = index_of(dst);
+		if (src_index == nodes_.size() || dst_index == nodes_.size()) {
+			throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::weights if src or dst node "
+			                         "don't exist in the graph");
+		}
+		auto const [first, last] = dst_range(src_index, dst_index);
+		return std::vector<E>(weights_.begin() + static_cast<std::ptrdiff_t>(first),
+		                      weights_.begin() + static_cast<std::ptrdiff_t>(last));
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto csr_graph<N, E>::connections(K const& src) const -> std::vector<N> {
+		auto const src_index = index_of(src);
+		if (src_index == nodes_.size()) {
+			throw std::runtime_error("Cannot call gdwg::csr_graph<N, E>::connections if src doesn't "
+			                         "exist in the graph");
+		}
+
+		auto result_vec = std::vector<N>{};
+		for (auto e = offsets_[src_index]; e < offsets_[src_index + 1]; e++) {
+			if (e == offsets_[src_index] || dsts_[e] != dsts_[e - 1]) {
+				result_vec.emplace_back(nodes_[dsts_[e]]);
+			}
+		}
+		return result_vec;
+	}
+
+	template<typename N, typename E>
+	[[nodiscard]] auto csr_graph<N, E>::begin() const noexcept -> iterator {
+		auto src = std::size_t{0};
+		while (src < nodes_.size() && offsets_[src + 1] == 0) {
+			src++;
+		}
+		return iterator(*this, src, 0);
+	}
+
+	template<typename N, typename E>
+	[[nodiscard]] auto csr_graph<N, E>::end() const noexcept -> iterator {
+		return iterator(*this, nodes_.size(), dsts_.size());
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto csr_graph<N, E>::find(S const& src, D const& dst, E const& weight) const
+	   -> iterator {
+		auto const src_index = index_of(src);
+		auto const dst_index = index_of(dst);
+		if (src_index == nodes_.size() || dst_index == nodes_.size()) {
+			return end();
+		}
+		auto const [first, last] = dst_range(src_index, dst_index);
+		auto const weights_first = weights_.begin() + static_cast<std::ptrdiff_t>(first);
+		auto const weights_last = weights_.begin() + static_cast<std::ptrdiff_t>(last);
+		auto const weight_search = std::lower_bound(weights_first, weights_last, weight);
+		if (weight_search == weights_last || weight < *weight_search) {
+			return end();
+		}
+		return iterator(*this, src_index, static_cast<std::size_t>(weight_search - weights_.begin()));
+	}
+
+	template<typename N, typename E>
+	template<typename K>
+	auto csr_graph<N, E>::index_of(K const& value) const -> std::size_t {
+		auto const search = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+		if (search == nodes_.end() || value < *search) {
+			return nodes_.size();
+		}
+		return static_cast<std::size_t>(search - nodes_.begin());
+	}
+
+	template<typename N, typename E>
+	auto csr_graph<N, E>::dst_range(std::size_t src, std::size_t dst) const
+	   -> std::pair<std::size_t, std::size_t> {
+		auto const row_first = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src]);
+		auto const row_last = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src + 1]);
+		auto const [first, last] = std::equal_range(row_first, row_last, static_cast<node_id>(dst));
+		return {static_cast<std::size_t>(first - dsts_.begin()),
+		        static_cast<std::size_t>(last - dsts_.begin())};
+	}
+
+} // namespace gdwg
+
+#endif
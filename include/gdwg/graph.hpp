@@ -1,70 +1,357 @@
 #ifndef GDWG_GRAPH_HPP
 #define GDWG_GRAPH_HPP
 
+#include "gdwg/csr_graph.hpp"
+#include "gdwg/lookup_key.hpp"
+#include "gdwg/memory_footprint.hpp"
+#include "gdwg/storage.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
 #include <ostream>
+#include <ranges>
 #include <set>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace gdwg {
-	template<typename N, typename E>
+	namespace detail {
+		// Specialised by algorithms such as gdwg::shortest_paths to walk a graph's own containers.
+		template<typename G>
+		struct adjacency_access;
+
+		// Moves iter forward past every element that before(element) holds for, where search()
+		// finds the same position from scratch. A few steps are taken before searching, so that
+		// a sorted batch of k targets costs O(V + k) when it is dense and O(k log V) when sparse.
+		template<typename Iter, typename Before, typename Search>
+		auto seek(Iter iter, Iter last, Before before, Search search) -> Iter {
+			for (auto steps = 0; steps < 8; steps++) {
+				if (iter == last || !before(*iter)) {
+					return iter;
+				}
+				++iter;
+			}
+			return iter == last || !before(*iter) ? iter : search();
+		}
+	} // namespace detail
+
+	// Storage selects the container behind each node's out- and in-edge sets; see storage.hpp.
+	template<typename N,
+	         typename E,
+	         typename Allocator = std::allocator<std::byte>,
+	         typename Storage = tree_storage>
 	class graph {
 	private:
 		class iterator;
+		class extracted_edge;
+		struct node_entry;
 
 	public:
 		using iterator = iterator;
+		using extracted_edge = extracted_edge;
 		using const_iterator = iterator;
+		using allocator_type = Allocator;
 		struct value_type {
 			N from;
 			N to;
 			E weight;
 		};
+		// What dereferencing an iterator yields: the parts of one edge, referring into the graph
+		// rather than copied out of it. It converts to value_type when a copy is wanted.
+		struct edge_reference {
+			N const& from;
+			N const& to;
+			E const& weight;
+
+			operator value_type() const {
+				return value_type{from, to, weight};
+			}
+		};
+
+		// Refers to one node of a graph without naming its value, so that the handle overloads
+		// of the edge operations skip the O(log V) search for it. A handle stays valid until its
+		// node is erased or replaced, or the graph is cleared or assigned to; a moved-from graph's
+		// handles refer to the graph it was moved into. A default-constructed handle is empty and
+		// names no node.
+		class node_handle {
+		public:
+			node_handle() = default;
+
+			explicit operator bool() const noexcept {
+				return entry_ != nullptr;
+			}
+			auto operator==(node_handle const& other) const -> bool = default;
+
+		private:
+			friend class graph;
+			node_entry const* entry_ = nullptr;
+
+			explicit node_handle(node_entry const* entry)
+			: entry_(entry) {}
+		};
 
 		graph();
-		graph(std::initializer_list<N> il);
+		explicit graph(Allocator const& alloc);
+		graph(std::initializer_list<N> il, Allocator const& alloc = Allocator());
 		template<typename InputIt>
-		graph(InputIt first, InputIt last);
-		graph(graph<N, E>&& other) noexcept;
-		auto operator=(graph<N, E>&& other) noexcept -> graph<N, E>&;
-		graph(graph<N, E> const& other);
-		auto operator=(graph<N, E> const& other) -> graph<N, E>&;
+		graph(InputIt first, InputIt last, Allocator const& alloc = Allocator());
+		template<std::ranges::input_range R>
+		requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+		         and (not std::same_as<std::remove_cvref_t<R>, graph>)
+		explicit graph(R&& edges, Allocator const& alloc = Allocator());
+		graph(graph<N, E, Allocator, Storage>&& other) noexcept;
+		auto operator=(graph<N, E, Allocator, Storage>&& other) noexcept(
+		   std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+		   || std::allocator_traits<Allocator>::is_always_equal::value)
+		   -> graph<N, E, Allocator, Storage>&;
+		graph(graph<N, E, Allocator, Storage> const& other);
+		graph(graph<N, E, Allocator, Storage> const& other, Allocator const& alloc);
+		auto operator=(graph<N, E, Allocator, Storage> const& other)
+		   -> graph<N, E, Allocator, Storage>&;
 
 		~graph() = default;
 
+		auto get_allocator() const noexcept -> allocator_type;
+
+		// Every parameter that only names an existing node accepts any detail::lookup_key<N>, so
+		// a graph<std::string, E> can be queried with literals or string_views without copying.
 		auto insert_node(N const& value) -> bool;
-		auto is_node(N const& value) const -> bool;
+		auto insert_node(N&& value) -> bool;
+		// Constructs the node in place from args. As with std::set::emplace, the node is built
+		// before it can be compared, and is destroyed again if it is already in the graph. Returns
+		// the handle of the node with that value and whether it was inserted.
+		template<typename... Args>
+		requires std::constructible_from<N, Args...>
+		auto emplace_node(Args&&... args) -> std::pair<node_handle, bool>;
+		// The handle of value, or an empty handle if value is not a node.
+		template<detail::lookup_key<N> K = N>
+		auto handle(K const& value) const -> node_handle;
+		template<detail::lookup_key<N> K = N>
+		auto is_node(K const& value) const -> bool;
 		[[nodiscard]] auto empty() const noexcept -> bool;
-		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool;
-		auto is_connected(N const& src, N const& dst) const -> bool;
+		// Counts are kept up to date by every modifier, so these take constant time once the node
+		// has been found. Degrees count edges, so parallel edges with different weights each count.
+		auto num_nodes() const noexcept -> std::size_t;
+		auto num_edges() const noexcept -> std::size_t;
+		// Adds up the heap memory held by each part of the graph, in O(V + E). Container nodes are
+		// sized as the major standard libraries lay them out, and values and weights count what
+		// heap_size reports for them.
+		auto memory_usage() const noexcept -> memory_footprint;
+		template<detail::lookup_key<N> K = N>
+		auto out_degree(K const& value) const -> std::size_t;
+		template<detail::lookup_key<N> K = N>
+		auto in_degree(K const& value) const -> std::size_t;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto insert_edge(S const& src, D const& dst, E const& weight) -> bool;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto insert_edge(S const& src, D const& dst, E&& weight) -> bool;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N, typename... Args>
+		requires std::constructible_from<E, Args...>
+		auto emplace_edge(S const& src, D const& dst, Args&&... args) -> bool;
+		// Adds every edge in the range, and any endpoint that is not a node yet. The input is
+		// sorted and deduplicated once, after which the graph is updated in a single ordered pass.
+		// Returns how many edges were new.
+		template<std::ranges::input_range R>
+		requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+		auto insert_edges(R&& edges) -> std::size_t;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto is_connected(S const& src, D const& dst) const -> bool;
+		// Answers is_connected(src, dst) for each of dsts in one walk over src's edges, so dsts
+		// has to be sorted in ascending order. A dst that is not a node is not connected.
+		template<detail::lookup_key<N> S = N, std::ranges::input_range R>
+		requires detail::lookup_key<std::ranges::range_value_t<R>, N>
+		auto is_connected_many(S const& src, R&& dsts) const -> std::vector<bool>;
 		auto nodes() const noexcept -> std::vector<N>;
-		auto replace_node(N const& old_data, N const& new_data) -> bool;
-		auto merge_replace_node(N const& old_data, N const& new_data) -> void;
-		auto erase_node(N const& value) -> bool;
-		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool;
+		template<detail::lookup_key<N> K = N>
+		auto replace_node(K const& old_data, N const& new_data) -> bool;
+		template<detail::lookup_key<N> K = N>
+		auto replace_node(K const& old_data, N&& new_data) -> bool;
+		template<detail::lookup_key<N> K1 = N, detail::lookup_key<N> K2 = N>
+		auto merge_replace_node(K1 const& old_data, K2 const& new_data) -> void;
+		// Renames many nodes at once: each key of mapping that is a node takes the value it maps
+		// to, or every node takes f(node), with f called once per node in ascending order. All
+		// renames happen together, so mapping a to b and b to a swaps them. A node renamed to the
+		// value of another node, or to the same value as another renamed node, is merged into it
+		// as merge_replace_node does. Only the renamed nodes' edges are detached, and they are
+		// reattached in one ordered pass, so the work follows the size of the mapping and those
+		// nodes' degrees. Handles of renamed nodes follow them, unless they were merged away.
+		// Returns how many nodes were renamed; a node renamed to its own value does not count.
+		template<std::ranges::input_range R>
+		requires detail::lookup_key<
+		            std::remove_cvref_t<std::tuple_element_t<0, std::ranges::range_value_t<R>>>,
+		            N>
+		         and std::constructible_from<
+		            N,
+		            std::tuple_element_t<1, std::ranges::range_value_t<R>> const&>
+		auto relabel(R&& mapping) -> std::size_t;
+		template<typename F>
+		requires std::invocable<F&, N const&>
+		         and std::constructible_from<N, std::invoke_result_t<F&, N const&>>
+		auto relabel(F f) -> std::size_t;
+		// Does merge_replace_node(old_data, new_data) for each (old_data, new_data) pair, in order,
+		// except that a node already merged away stands for the node it was merged into, so chains
+		// and cycles of pairs are fine. The pairs are resolved with union-find, and the edges of
+		// the merged nodes are gathered from their own sets and the in-edge index and moved
+		// together. Throws before changing anything if a pair names a node that doesn't exist.
+		// Returns how many nodes were merged away.
+		template<std::ranges::input_range R>
+		requires detail::lookup_key<
+		            std::remove_cvref_t<std::tuple_element_t<0, std::ranges::range_value_t<R>>>,
+		            N>
+		         and detail::lookup_key<
+		            std::remove_cvref_t<std::tuple_element_t<1, std::ranges::range_value_t<R>>>,
+		            N>
+		auto merge_replace_nodes(R&& pairs) -> std::size_t;
+		template<detail::lookup_key<N> K = N>
+		auto erase_node(K const& value) -> bool;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto erase_edge(S const& src, D const& dst, E const& weight) -> bool;
 		auto clear() noexcept -> void;
-		auto weights(N const& src, N const& dst) const -> std::vector<E>;
-		auto connections(N const& src) const -> std::vector<N>;
-		auto operator==(graph<N, E> const& other) const noexcept -> bool;
+		// Moves every node and edge of other that this graph lacks into it, as std::set::merge
+		// does. While the allocators are equal, nodes, edges and in-edge index entries are
+		// relinked rather than copied, and what other gives up is reused before anything new is
+		// allocated. Under flat_storage only elements kept in a tree are relinked, and only into
+		// a tree or an empty set; anything else is moved into the receiving set, which may have
+		// to grow. other keeps the nodes whose values this graph already had and the edges
+		// between them that it already had. Handles to moved nodes now refer to this graph.
+		auto merge(graph<N, E, Allocator, Storage>& other) -> void;
+		auto merge(graph<N, E, Allocator, Storage>&& other) -> void;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto weights(S const& src, D const& dst) const -> std::vector<E>;
+		template<detail::lookup_key<N> K = N>
+		auto connections(K const& src) const -> std::vector<N>;
+		// Views over the graph's own containers, which copy nothing. Each one models
+		// std::ranges::view and is invalidated by the same modifiers that invalidate iterators.
+		// nodes_view() yields N const& in ascending order, out_edges(src) yields a
+		// std::pair<N const&, E const&> for each edge out of src, connections_view(src) yields
+		// each of src's distinct destinations once, and weights_view(src, dst) yields E const&.
+		auto nodes_view() const;
+		template<detail::lookup_key<N> K = N>
+		auto out_edges(K const& src) const;
+		template<detail::lookup_key<N> K = N>
+		auto connections_view(K const& src) const;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto weights_view(S const& src, D const& dst) const;
+		// Call f on every node, every edge, or every edge out of src, in iteration order, with
+		// references into the graph. If f returns a value, it is tested as a bool and a false
+		// result stops the walk. Each returns false if it was stopped early and true otherwise.
+		// f must not modify the graph.
+		template<typename F>
+		requires std::invocable<F&, N const&>
+		auto for_each_node(F&& f) const -> bool;
+		template<typename F>
+		requires std::invocable<F&, N const&, N const&, E const&>
+		auto for_each_edge(F&& f) const -> bool;
+		template<detail::lookup_key<N> K = N, typename F>
+		requires std::invocable<F&, N const&, E const&>
+		auto for_each_out_edge(K const& src, F&& f) const -> bool;
+		// Split the sources into up to num_threads runs of consecutive sources holding about the
+		// same number of edges, and walk each run on its own thread, one of them the caller's.
+		// f and transform are called concurrently, so they must be safe to call that way.
+		// parallel_reduce_edges combines each run's transformed edges in order, then the runs in
+		// order after init, so reduce has to be associative but need not be commutative. The
+		// first exception thrown by a run is rethrown once every thread has finished.
+		template<typename F>
+		requires std::invocable<F&, N const&, N const&, E const&>
+		auto parallel_for_each_edge(F&& f, unsigned num_threads = std::thread::hardware_concurrency())
+		   const -> void;
+		template<typename T, typename Reduce, typename Transform>
+		requires std::invocable<Transform&, N const&, N const&, E const&>
+		         and std::convertible_to<std::invoke_result_t<Reduce&, T, T>, T>
+		auto parallel_reduce_edges(T init,
+		                           Reduce reduce,
+		                           Transform transform,
+		                           unsigned num_threads = std::thread::hardware_concurrency()) const
+		   -> T;
+		auto operator==(graph<N, E, Allocator, Storage> const& other) const noexcept -> bool;
 		auto begin() const noexcept -> iterator;
 		auto end() const noexcept -> iterator;
-		auto find(N const& src, N const& dst, E const& weight) const -> iterator;
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto find(S const& src, D const& dst, E const& weight) const -> iterator;
 		auto erase_edge(iterator i) -> iterator;
 		auto erase_edge(iterator i, iterator s) -> iterator;
-		friend auto operator<<(std::ostream& os, graph<N, E> const& g) -> std::ostream& {
+		// Take an edge out of the graph without freeing the memory it is stored in, as
+		// std::set::extract does, so that insert_edge can put it back into this graph or another,
+		// perhaps with a new weight, without allocating unless the graphs' allocators differ.
+		// Extracting an edge that is not in the graph gives an empty extracted_edge.
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto extract_edge(S const& src, D const& dst, E const& weight) -> extracted_edge;
+		auto extract_edge(iterator i) -> extracted_edge;
+		// Inserts edge between the nodes with the values of its endpoints, leaving edge empty.
+		// Returns false, and leaves edge as it was, if it is empty or already in the graph.
+		auto insert_edge(extracted_edge&& edge) -> bool;
+		// Gives the edge from src to dst with old_weight the weight new_weight, reusing its memory.
+		// Returns false and changes nothing if there is no such edge, or if another edge from src
+		// to dst already has new_weight.
+		template<detail::lookup_key<N> S = N, detail::lookup_key<N> D = N>
+		auto update_weight(S const& src, D const& dst, E const& old_weight, E const& new_weight)
+		   -> bool;
+		// Erase every edge, or every node and its edges, that pred holds for. pred is called once
+		// for each edge or node, and erase_nodes_if then removes the edges of the nodes it picked
+		// as erase_nodes does. Both return how many were erased.
+		template<typename Pred>
+		requires std::predicate<Pred&, N const&, N const&, E const&>
+		auto erase_edges_if(Pred pred) -> std::size_t;
+		template<typename Pred>
+		requires std::predicate<Pred&, N const&>
+		auto erase_nodes_if(Pred pred) -> std::size_t;
+		// Erases every listed node that exists, with all their edges, at a cost that follows the
+		// listed nodes' degrees unless they hold a large share of the graph's edges, when every
+		// edge is swept once instead. Returns how many nodes were erased.
+		template<std::input_iterator InputIt>
+		requires detail::lookup_key<std::iter_value_t<InputIt>, N>
+		auto erase_nodes(InputIt first, InputIt last) -> std::size_t;
+		template<std::ranges::input_range R>
+		requires detail::lookup_key<std::ranges::range_value_t<R>, N>
+		auto erase_nodes(R&& values) -> std::size_t;
+		auto freeze() const -> csr_graph<N, E>;
+
+		// Edge operations on handles throw or return as their value counterparts do when a handle
+		// is empty. A handle that is no longer valid must not be passed.
+		auto insert_edge(node_handle src, node_handle dst, E const& weight) -> bool;
+		auto insert_edge(node_handle src, node_handle dst, E&& weight) -> bool;
+		template<typename... Args>
+		requires std::constructible_from<E, Args...>
+		auto emplace_edge(node_handle src, node_handle dst, Args&&... args) -> bool;
+		auto is_connected(node_handle src, node_handle dst) const -> bool;
+		auto weights(node_handle src, node_handle dst) const -> std::vector<E>;
+		auto find(node_handle src, node_handle dst, E const& weight) const -> iterator;
+		auto erase_edge(node_handle src, node_handle dst, E const& weight) -> bool;
+		auto update_weight(node_handle src,
+		                   node_handle dst,
+		                   E const& old_weight,
+		                   E const& new_weight) -> bool;
+		auto out_degree(node_handle node) const -> std::size_t;
+		auto in_degree(node_handle node) const -> std::size_t;
+
+		friend auto operator<<(std::ostream& os, graph<N, E, Allocator, Storage> const& g)
+		   -> std::ostream& {
 			auto const& nodes = g.nodes_rep_;
 			auto const& edges = g.edges_rep_;
 
 			for (auto iter = nodes.begin(); iter != nodes.end(); iter++) {
-				os << **iter << " (\n";
-				auto const edges__map_iter = edges.find(*iter);
+				os << (*iter)->value << " (\n";
+				auto const edges__map_iter = edges.find(iter->get());
 				if (edges__map_iter != edges.end()) {
 					auto const& edges_set = edges__map_iter->second;
 					for (auto edges_set_iter = edges_set.begin(); edges_set_iter != edges_set.end();
 					     edges_set_iter++) {
-						os << "  " << *(edges_set_iter->first) << " | " << edges_set_iter->second << "\n";
+						os << "  " << edges_set_iter->first->value << " | " << edges_set_iter->second
+						   << "\n";
 					}
 				}
 				os << ")\n";
@@ -74,36 +361,201 @@ namespace gdwg {
 		}
 
 	private:
-		std::set<std::unique_ptr<N>> node_u_ptrs_;
+		template<typename G>
+		friend struct detail::adjacency_access;
+
+		using alloc_traits = std::allocator_traits<Allocator>;
+		template<typename T>
+		using rebind_alloc = typename alloc_traits::template rebind_alloc<T>;
+		using rank_t = std::uint64_t;
+
+		// Every node is interned once, as an entry that the edge containers point at. An entry's
+		// rank follows the order of its value among the graph's nodes, so every container except
+		// nodes_rep_ orders nodes by comparing ranks and never has to compare two N values.
+		struct node_entry {
+			// The value gets the graph's allocator if it uses one, as a pmr::string would.
+			template<typename ValueAlloc, typename... Args>
+			node_entry(std::uint32_t node_id, ValueAlloc const& alloc, Args&&... args)
+			: value(std::make_obj_using_allocator<N>(alloc, std::forward<Args>(args)...))
+			, id(node_id) {}
+
+			N value;
+			// Dense and reused once the node is erased, so it can index per-node scratch arrays.
+			std::uint32_t id;
+			rank_t rank = 0;
+			// The edge containers only hold const entries, but still have to keep these current.
+			mutable std::size_t out_degree = 0;
+			mutable std::size_t in_degree = 0;
+		};
+		using entry_alloc_traits = std::allocator_traits<rebind_alloc<node_entry>>;
+
+		// Entries come from the graph's allocator, so each owner carries a copy of it to free them.
+		struct node_deleter {
+			[[no_unique_address]] rebind_alloc<node_entry> alloc;
+
+			auto operator()(node_entry* entry) -> void {
+				entry_alloc_traits::destroy(alloc, entry);
+				entry_alloc_traits::deallocate(alloc, entry, 1);
+			}
+		};
+		using node_owner = std::unique_ptr<node_entry, node_deleter>;
+
+		// Orders nodes_rep_ by value, and lets it be searched with anything comparable with N.
+		struct value_compare {
+			using is_transparent = void;
+
+			auto operator()(node_owner const& n1, node_owner const& n2) const -> bool {
+				return n1->value < n2->value;
+			}
+			template<typename K>
+			auto operator()(node_owner const& n1, K const& n2) const -> bool {
+				return n1->value < n2;
+			}
+			template<typename K>
+			auto operator()(K const& n1, node_owner const& n2) const -> bool {
+				return n1 < n2->value;
+			}
+		};
+
 		struct node_compare {
-			auto operator()(N const* n1, N const* n2) const -> bool {
-				return (*n1 < *n2);
+			auto operator()(node_entry const* n1, node_entry const* n2) const -> bool {
+				return n1->rank < n2->rank;
 			}
 		};
 
 		struct edge_compare {
-			auto operator()(std::pair<N const*, E> const& pair_1,
-			                std::pair<N const*, E> const& pair_2) const -> bool {
-				if (*(pair_1.first) != *(pair_2.first)) {
-					return *(pair_1.first) < *(pair_2.first);
+			using is_transparent = void;
+
+			auto operator()(std::pair<node_entry const*, E> const& pair_1,
+			                std::pair<node_entry const*, E> const& pair_2) const -> bool {
+				if (pair_1.first != pair_2.first) {
+					return pair_1.first->rank < pair_2.first->rank;
 				}
 
 				return pair_1.second < pair_2.second;
 			}
+
+			// Compares on the destination only, so equal_range(dst) yields every weight to dst.
+			auto operator()(std::pair<node_entry const*, E> const& pair_1, node_entry const* dst) const
+			   -> bool {
+				return pair_1.first->rank < dst->rank;
+			}
+			auto operator()(node_entry const* dst, std::pair<node_entry const*, E> const& pair_2) const
+			   -> bool {
+				return dst->rank < pair_2.first->rank;
+			}
 		};
 
-		std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare> edges_rep_;
-		std::set<N const*, node_compare> nodes_rep_;
+		template<typename T, typename Compare>
+		using storage_set_t = typename Storage::template set_type<T, Compare, rebind_alloc<T>>;
+
+		using edges_set_t = storage_set_t<std::pair<node_entry const*, E>, edge_compare>;
+		using edges_map_t = std::map<node_entry const*,
+		                             edges_set_t,
+		                             node_compare,
+		                             rebind_alloc<std::pair<node_entry const* const, edges_set_t>>>;
+		using sources_set_t = storage_set_t<node_entry const*, node_compare>;
+		using sources_map_t =
+		   std::map<node_entry const*,
+		            sources_set_t,
+		            node_compare,
+		            rebind_alloc<std::pair<node_entry const* const, sources_set_t>>>;
+		using nodes_set_t = std::set<node_owner, value_compare, rebind_alloc<node_owner>>;
+
+		edges_map_t edges_rep_;
+		// For each node with incoming edges, the set of nodes that have at least one edge to it.
+		sources_map_t in_edges_rep_;
+		// Owns every node and orders them by value, so a node can be found and freed in O(log V).
+		nodes_set_t nodes_rep_;
+		// Ids of erased nodes, handed out again before id_bound_ is raised.
+		std::vector<std::uint32_t, rebind_alloc<std::uint32_t>> free_ids_;
+		std::uint32_t id_bound_ = 0;
+		std::size_t num_edges_ = 0;
+
+		using edges_map_iter_t = typename edges_map_t::const_iterator;
+		using edges_set_iter_t = typename edges_set_t::const_iterator;
+
+		class dst_iterator;
+		struct node_value_fn {
+			auto operator()(node_owner const& owner) const -> N const& {
+				return owner->value;
+			}
+		};
+		struct edge_ref_fn {
+			auto operator()(std::pair<node_entry const*, E> const& edge) const
+			   -> std::pair<N const&, E const&> {
+				return {edge.first->value, edge.second};
+			}
+		};
 
-		using edges_map_iter_t =
-		   typename std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare>::const_iterator;
-		using edges_set_iter_t =
-		   typename std::set<std::pair<N const*, E>, edge_compare>::const_iterator;
+		template<typename K>
+		auto find_entry(K const& value) const -> node_entry const*;
+		auto next_id() const -> std::uint32_t;
+		template<typename... Args>
+		auto make_node(std::uint32_t id, Args&&... args) -> node_owner;
+		auto link_node(typename nodes_set_t::const_iterator hint, node_owner owner)
+		   -> typename nodes_set_t::iterator;
+		auto link_node(typename nodes_set_t::const_iterator hint,
+		               typename nodes_set_t::node_type node) -> typename nodes_set_t::iterator;
+		auto assign_rank(typename nodes_set_t::iterator iter) -> void;
+
+		template<typename K, typename V>
+		auto replace_node_value(K const& old_data, V&& new_data) -> bool;
+		// Gives each listed node its new value, and returns how many there were. Entries have to
+		// be distinct and their new values different from their current ones.
+		auto relabel_entries(std::vector<std::pair<node_entry const*, N>>& renames) -> std::size_t;
+		struct pending_edge {
+			node_entry const* src;
+			node_entry const* dst;
+			E weight;
+		};
+		// Sorts and deduplicates pending, then adds its edges in a single ordered pass over the
+		// edge containers. Returns how many edges were new.
+		auto insert_pending_edges(std::vector<pending_edge>& pending) -> std::size_t;
+		template<typename... Args>
+		auto emplace_edge_ptr(node_entry const* src, node_entry const* dst, Args&&... args) -> bool;
+		auto is_connected_ptr(node_entry const* src, node_entry const* dst) const -> bool;
+		auto weights_ptr(node_entry const* src, node_entry const* dst) const -> std::vector<E>;
+		auto find_ptr(node_entry const* src, node_entry const* dst, E const& weight) const
+		   -> iterator;
+		auto update_weight_ptr(node_entry const* src,
+		                       node_entry const* dst,
+		                       E const& old_weight,
+		                       E const& new_weight) -> bool;
+		// src's out-edges, which are empty if src has none.
+		auto edges_of(node_entry const* src) const -> std::ranges::subrange<edges_set_iter_t>;
+		template<typename F, typename... Args>
+		static auto visit(F& f, Args const&... args) -> bool;
+		// The boundaries of at most num_runs runs of sources with about equal edge counts.
+		auto partition_sources(unsigned num_runs) const -> std::vector<edges_map_iter_t>;
+		// Calls work(i) for every i below num_tasks, all but the first on new threads.
+		template<typename Work>
+		static auto run_in_parallel(std::size_t num_tasks, Work& work) -> void;
+		auto unlink_source(node_entry const* src, node_entry const* dst) -> void;
+		auto erase_incident_edges(node_entry const* node) -> void;
+		// Appends every edge touching one of nodes to pending, once each, from the nodes' own
+		// sets and the in-edge index. nodes has to be sorted by address.
+		auto collect_edges(std::vector<node_entry const*> const& nodes,
+		                   std::vector<pending_edge>& pending) const -> void;
+		// Erases each edge that pred(src entry, dst entry, weight) holds for, and returns how many.
+		template<typename Pred>
+		auto erase_edges_where(Pred pred) -> std::size_t;
+		// Erases every edge touching one of nodes. Each node's edges are reached through its own
+		// set and the in-edge index, unless between them they hold a large share of the graph's
+		// edges, when a single sweep over every edge is cheaper.
+		auto erase_edges_of(std::vector<node_entry const*> const& nodes) -> void;
+		// Erases the distinct nodes in doomed, and all their edges.
+		auto erase_doomed_nodes(std::vector<node_entry const*> const& doomed) -> void;
+		auto erase_node_ptr(node_entry const* node) -> void;
+		// The edge at set_iter, or the first edge of a later source if set_iter is the end of
+		// map_iter's set, in which case map_iter's entry is dropped if its set is now empty.
+		auto iterator_at(typename edges_map_t::iterator map_iter, edges_set_iter_t set_iter)
+		   -> iterator;
 
 		class iterator {
 		public:
-			using value_type = graph<N, E>::value_type;
-			using reference = value_type;
+			using value_type = graph<N, E, Allocator, Storage>::value_type;
+			using reference = edge_reference;
 			using pointer = void;
 			using difference_type = std::ptrdiff_t;
 			using iterator_category = std::bidirectional_iterator_tag;
@@ -111,9 +563,9 @@ namespace gdwg {
 			iterator() = default;
 
 			auto operator*() const -> reference {
-				return value_type{*(curr_map_iter_->first),
-				                  *(curr_set_iter_->first),
-				                  curr_set_iter_->second};
+				return reference{curr_map_iter_->first->value,
+				                 curr_set_iter_->first->value,
+				                 curr_set_iter_->second};
 			}
 
 			auto operator++() -> iterator& {
@@ -121,7 +573,7 @@ namespace gdwg {
 				curr_set_iter_++;
 				if (curr_set_iter_ == curr_set_end) {
 					curr_map_iter_++;
-					if (curr_map_iter_ != edges_map_end_) {
+					if (curr_map_iter_ != edges_->end()) {
 						curr_set_iter_ = curr_map_iter_->second.begin();
 					}
 					else {
@@ -136,15 +588,15 @@ namespace gdwg {
 				return before_iterator;
 			}
 			auto operator--() -> iterator& {
-				if (curr_map_iter_ == edges_map_end_) {
-					curr_map_iter_ = std::prev(edges_map_end_, 1);
+				if (curr_map_iter_ == edges_->end()) {
+					curr_map_iter_ = std::prev(edges_->end(), 1);
 					curr_set_iter_ = std::prev(curr_map_iter_->second.end(), 1);
 					return *this;
 				}
 
 				auto const curr_set_begin = curr_map_iter_->second.begin();
 				if (curr_set_iter_ == curr_set_begin) {
-					if (curr_map_iter_ != edges_map_begin_) {
+					if (curr_map_iter_ != edges_->begin()) {
 						curr_map_iter_--;
 						curr_set_iter_ = std::prev(curr_map_iter_->second.end(), 1);
 					}
@@ -161,330 +613,930 @@ namespace gdwg {
 			}
 
 			auto operator==(iterator const& other) const -> bool {
-				return (curr_map_iter_ == other.curr_map_iter_ && curr_set_iter_ == other.curr_set_iter_);
+				return (curr_map_iter_ == other.curr_map_iter_
+				        && curr_set_iter_ == other.curr_set_iter_);
 			}
 
 		private:
-			friend class graph<N, E>;
-			edges_map_iter_t edges_map_begin_;
-			edges_map_iter_t edges_map_end_;
+			friend class graph<N, E, Allocator, Storage>;
+			// The map is only needed to tell where its sources begin and end.
+			edges_map_t const* edges_ = nullptr;
 			edges_map_iter_t curr_map_iter_;
 			edges_set_iter_t curr_set_iter_;
 
-			explicit iterator(
-			   std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare> const& edges)
-			: edges_map_begin_(edges.begin())
-			, edges_map_end_(edges.end())
+			explicit iterator(edges_map_t const& edges)
+			: edges_(&edges)
 			, curr_map_iter_(edges.begin()) {
 				if (!edges.empty()) {
 					curr_set_iter_ = edges.begin()->second.begin();
 				}
 			}
 
-			explicit iterator(
-			   std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare> const& edges,
-			   bool)
-			: edges_map_begin_(edges.begin())
-			, edges_map_end_(edges.end())
+			explicit iterator(edges_map_t const& edges, bool)
+			: edges_(&edges)
 			, curr_map_iter_(edges.end()) {}
 
-			explicit iterator(
-			   std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare> const& edges,
-			   edges_map_iter_t map_iter,
-			   edges_set_iter_t set_iter)
-			: edges_map_begin_(edges.begin())
-			, edges_map_end_(edges.end())
+			explicit iterator(edges_map_t const& edges,
+			                  edges_map_iter_t map_iter,
+			                  edges_set_iter_t set_iter)
+			: edges_(&edges)
 			, curr_map_iter_(map_iter)
 			, curr_set_iter_(set_iter) {}
 		};
+
+		// Walks one node's out-edges, stopping only at the first edge to each destination.
+		class dst_iterator {
+		public:
+			using value_type = N;
+			using reference = N const&;
+			using difference_type = std::ptrdiff_t;
+			using iterator_concept = std::forward_iterator_tag;
+			using iterator_category = std::forward_iterator_tag;
+
+			dst_iterator() = default;
+
+			auto operator*() const -> reference {
+				return iter_->first->value;
+			}
+
+			auto operator++() -> dst_iterator& {
+				auto const dst = iter_->first;
+				do {
+					++iter_;
+				} while (iter_ != last_ && iter_->first == dst);
+				return *this;
+			}
+			auto operator++(int) -> dst_iterator {
+				auto before_iterator = *this;
+				++*this;
+				return before_iterator;
+			}
+
+			auto operator==(dst_iterator const& other) const -> bool {
+				return iter_ == other.iter_;
+			}
+
+		private:
+			friend class graph<N, E, Allocator, Storage>;
+			edges_set_iter_t iter_;
+			edges_set_iter_t last_;
+
+			dst_iterator(edges_set_iter_t iter, edges_set_iter_t last)
+			: iter_(iter)
+			, last_(last) {}
+		};
+
+		// An edge taken out of a graph by extract_edge, which keeps the node of the set it was
+		// stored in. Its endpoints are read through their entries in that graph, so both have to
+		// stay in it until the edge is inserted or dropped.
+		class extracted_edge {
+		public:
+			extracted_edge() = default;
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return node_.empty();
+			}
+			explicit operator bool() const noexcept {
+				return !empty();
+			}
+			auto from() const -> N const& {
+				return src_->value;
+			}
+			auto to() const -> N const& {
+				return node_.value().first->value;
+			}
+			auto weight() -> E& {
+				return node_.value().second;
+			}
+			auto weight() const -> E const& {
+				return node_.value().second;
+			}
+
+		private:
+			friend class graph<N, E, Allocator, Storage>;
+			node_entry const* src_ = nullptr;
+			typename edges_set_t::node_type node_;
+
+			extracted_edge(node_entry const* src, typename edges_set_t::node_type node)
+			: src_(src)
+			, node_(std::move(node)) {}
+		};
 	};
 
-	template<typename N, typename E>
-	graph<N, E>::graph() = default;
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph() = default;
 
-	template<typename N, typename E>
-	graph<N, E>::graph(std::initializer_list<N> il)
-	: graph(il.begin(), il.end()) {}
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph(Allocator const& alloc)
+	: edges_rep_(alloc)
+	, in_edges_rep_(alloc)
+	, nodes_rep_(alloc)
+	, free_ids_(alloc) {}
 
-	template<typename N, typename E>
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph(std::initializer_list<N> il, Allocator const& alloc)
+	: graph(il.begin(), il.end(), alloc) {}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
 	template<typename InputIt>
-	graph<N, E>::graph(InputIt first, InputIt last) {
+	graph<N, E, Allocator, Storage>::graph(InputIt first, InputIt last, Allocator const& alloc)
+	: graph(alloc) {
 		for (auto iter = first; iter != last; iter++) {
 			insert_node(*iter);
 		}
 	}
 
-	template<typename N, typename E>
-	graph<N, E>::graph(graph<N, E>&& other) noexcept
-	: node_u_ptrs_(std::exchange(other.node_u_ptrs_, std::set<std::unique_ptr<N>>{}))
-	, edges_rep_(std::exchange(
-	     other.edges_rep_,
-	     std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare>{}))
-	, nodes_rep_(std::exchange(other.nodes_rep_, std::set<N const*, node_compare>{})) {}
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::ranges::input_range R>
+	requires std::convertible_to<std::ranges::range_reference_t<R>,
+	                             typename graph<N, E, Allocator, Storage>::value_type>
+	         and (not std::same_as<std::remove_cvref_t<R>, graph<N, E, Allocator, Storage>>)
+	graph<N, E, Allocator, Storage>::graph(R&& edges, Allocator const& alloc)
+	: graph(alloc) {
+		insert_edges(std::forward<R>(edges));
+	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::operator=(graph<N, E>&& other) noexcept -> graph<N, E>& {
-		node_u_ptrs_ = std::exchange(other.node_u_ptrs_, std::set<std::unique_ptr<N>>{});
-		edges_rep_ = std::exchange(
-		   other.edges_rep_,
-		   std::map<N const*, std::set<std::pair<N const*, E>, edge_compare>, node_compare>{});
-		nodes_rep_ = std::exchange(other.nodes_rep_, std::set<N const*, node_compare>{});
-		return *this;
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph(graph<N, E, Allocator, Storage>&& other) noexcept
+	: edges_rep_(std::move(other.edges_rep_))
+	, in_edges_rep_(std::move(other.in_edges_rep_))
+	, nodes_rep_(std::move(other.nodes_rep_))
+	, free_ids_(std::move(other.free_ids_))
+	, id_bound_(other.id_bound_)
+	, num_edges_(other.num_edges_) {
+		other.clear();
 	}
 
-	template<typename N, typename E>
-	graph<N, E>::graph(graph<N, E> const& other) {
-		for (auto const& ptr : other.nodes_rep_) {
-			insert_node(*ptr);
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::operator=(graph<N, E, Allocator, Storage>&& other)
+	   noexcept(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+	            || std::allocator_traits<Allocator>::is_always_equal::value)
+	   -> graph<N, E, Allocator, Storage>& {
+		if (this == &other) {
+			return *this;
+		}
+		// Nodes can only be stolen if this graph will be able to free them.
+		if constexpr (!alloc_traits::propagate_on_container_move_assignment::value
+		              && !alloc_traits::is_always_equal::value)
+		{
+			if (get_allocator() != other.get_allocator()) {
+				*this = static_cast<graph<N, E, Allocator, Storage> const&>(other);
+				other.clear();
+				return *this;
+			}
 		}
+		clear();
+		edges_rep_ = std::move(other.edges_rep_);
+		in_edges_rep_ = std::move(other.in_edges_rep_);
+		nodes_rep_ = std::move(other.nodes_rep_);
+		free_ids_ = std::move(other.free_ids_);
+		id_bound_ = other.id_bound_;
+		num_edges_ = other.num_edges_;
+		other.clear();
+		return *this;
+	}
 
-		for (auto iter = other.edges_rep_.begin(); iter != other.edges_rep_.end(); iter++) {
-			auto const& curr_edges = iter->second;
-			auto const& curr_src = iter->first;
-			for (auto iter2 = curr_edges.begin(); iter2 != curr_edges.end(); iter2++) {
-				insert_edge(*curr_src, *(iter2->first), iter2->second);
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph(graph<N, E, Allocator, Storage> const& other)
+	: graph(other, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	graph<N, E, Allocator, Storage>::graph(graph<N, E, Allocator, Storage> const& other,
+	                                       Allocator const& alloc)
+	: graph(alloc) {
+		// Every container of other is already sorted, so each one is rebuilt in a single pass of
+		// end-hinted inserts. Nodes keep their ids and ranks, which lets edges find their copied
+		// endpoints through an id-indexed table.
+		auto entries = std::vector<node_entry const*>(other.id_bound_);
+		for (auto const& node : other.nodes_rep_) {
+			auto owner = make_node(node->id, node->value);
+			owner->rank = node->rank;
+			owner->out_degree = node->out_degree;
+			owner->in_degree = node->in_degree;
+			entries[node->id] = nodes_rep_.emplace_hint(nodes_rep_.end(), std::move(owner))->get();
+		}
+		free_ids_.assign(other.free_ids_.begin(), other.free_ids_.end());
+		id_bound_ = other.id_bound_;
+		num_edges_ = other.num_edges_;
+
+		for (auto const& [src, src_edges] : other.edges_rep_) {
+			auto edges = edges_set_t(edges_rep_.get_allocator());
+			for (auto const& [dst, weight] : src_edges) {
+				edges.emplace_hint(edges.end(), entries[dst->id], weight);
+			}
+			edges_rep_.emplace_hint(edges_rep_.end(), entries[src->id], std::move(edges));
+		}
+		for (auto const& [dst, dst_sources] : other.in_edges_rep_) {
+			auto sources = sources_set_t(in_edges_rep_.get_allocator());
+			for (auto const src : dst_sources) {
+				sources.emplace_hint(sources.end(), entries[src->id]);
 			}
+			in_edges_rep_.emplace_hint(in_edges_rep_.end(), entries[dst->id], std::move(sources));
 		}
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::operator=(graph<N, E> const& other) -> graph<N, E>& {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::operator=(graph<N, E, Allocator, Storage> const& other)
+	   -> graph<N, E, Allocator, Storage>& {
 		if (this == &other) {
 			return *this;
 		}
-		for (auto const& ptr : other.nodes_rep_) {
-			insert_node(*ptr);
-		}
+		// Building the copy first leaves this graph untouched if copying throws.
+		auto const alloc = alloc_traits::propagate_on_container_copy_assignment::value
+		                      ? other.get_allocator()
+		                      : get_allocator();
+		*this = graph<N, E, Allocator, Storage>(other, alloc);
+		return *this;
+	}
 
-		for (auto iter = other.edges_rep_.begin(); iter != other.edges_rep_.end(); iter++) {
-			auto const& curr_edges = iter->second;
-			auto const& curr_src = iter->first;
-			for (auto iter2 = curr_edges.begin(); iter2 != curr_edges.end(); iter2++) {
-				insert_edge(*curr_src, *(iter2->first), iter2->second);
-			}
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_node(N const& value) -> bool {
+		auto const hint = nodes_rep_.lower_bound(value);
+		if (hint != nodes_rep_.end() && !(value < (*hint)->value)) {
+			return false;
 		}
-		return *this;
+		link_node(hint, make_node(next_id(), value));
+		return true;
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::insert_node(N const& value) -> bool {
-		if (is_node(value)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_node(N&& value) -> bool {
+		// value is only moved from once it is known to be new.
+		auto const hint = nodes_rep_.lower_bound(value);
+		if (hint != nodes_rep_.end() && !(value < (*hint)->value)) {
 			return false;
 		}
-		auto const emplaced = node_u_ptrs_.emplace(std::make_unique<N>(value));
-		nodes_rep_.emplace((*(emplaced.first)).get());
+		link_node(hint, make_node(next_id(), std::move(value)));
 		return true;
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::is_node(N const& value) const -> bool {
-		return nodes_rep_.contains(&value);
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename... Args>
+	requires std::constructible_from<N, Args...>
+	auto graph<N, E, Allocator, Storage>::emplace_node(Args&&... args)
+	   -> std::pair<node_handle, bool> {
+		auto owner = make_node(next_id(), std::forward<Args>(args)...);
+		auto const hint = nodes_rep_.lower_bound(owner->value);
+		if (hint != nodes_rep_.end() && !(owner->value < (*hint)->value)) {
+			return {node_handle(hint->get()), false};
+		}
+		return {node_handle(link_node(hint, std::move(owner))->get()), true};
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::handle(K const& value) const
+	   -> node_handle {
+		return node_handle(find_entry(value));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::get_allocator() const noexcept
+	   -> allocator_type {
+		return allocator_type(nodes_rep_.get_allocator());
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::is_node(K const& value) const -> bool {
+		return nodes_rep_.contains(value);
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::empty() const noexcept -> bool {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::empty() const noexcept -> bool {
 		return nodes_rep_.empty();
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::insert_edge(N const& src, N const& dst, E const& weight) -> bool {
-		if (!is_node(src) || !is_node(dst)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::num_nodes() const noexcept -> std::size_t {
+		return nodes_rep_.size();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::num_edges() const noexcept -> std::size_t {
+		return num_edges_;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::memory_usage() const noexcept
+	   -> memory_footprint {
+		auto usage = memory_footprint{};
+		for (auto const& node : nodes_rep_) {
+			usage.node_values += heap_size<N>()(node->value);
+		}
+		usage.node_entries = nodes_rep_.size() * sizeof(node_entry);
+		usage.node_set = detail::container_bytes(nodes_rep_);
+		usage.edge_maps = detail::container_bytes(edges_rep_);
+		for (auto const& [src, src_edges] : edges_rep_) {
+			usage.edge_sets += detail::container_bytes(src_edges);
+			for (auto const& [dst, weight] : src_edges) {
+				usage.edge_weights += heap_size<E>()(weight);
+			}
+		}
+		usage.in_edge_index = detail::container_bytes(in_edges_rep_);
+		for (auto const& [dst, dst_sources] : in_edges_rep_) {
+			usage.in_edge_index += detail::container_bytes(dst_sources);
+		}
+		usage.free_ids = free_ids_.capacity() * sizeof(std::uint32_t);
+		return usage;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::out_degree(K const& value) const
+	   -> std::size_t {
+		auto const entry = find_entry(value);
+		if (entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_degree on a node that "
+			                         "doesn't exist");
+		}
+		return entry->out_degree;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::in_degree(K const& value) const
+	   -> std::size_t {
+		auto const entry = find_entry(value);
+		if (entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_degree on a node that "
+			                         "doesn't exist");
+		}
+		return entry->in_degree;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	auto graph<N, E, Allocator, Storage>::insert_edge(S const& src, D const& dst, E const& weight)
+	   -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
 			throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or "
 			                         "dst node does not exist");
 		}
 
-		auto src_search = edges_rep_.find(&src);
-		if (src_search == edges_rep_.end()) {
-			auto const empty_edges = std::set<std::pair<N const*, E>, edge_compare>();
-			auto const& src_nodes_rep_search = nodes_rep_.find(&src);
-			edges_rep_.emplace(*src_nodes_rep_search, empty_edges);
-			src_search = edges_rep_.find(&src);
+		return emplace_edge_ptr(src_entry, dst_entry, weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	auto graph<N, E, Allocator, Storage>::insert_edge(S const& src, D const& dst, E&& weight)
+	   -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or "
+			                         "dst node does not exist");
 		}
 
-		auto dst_search = nodes_rep_.find(&dst);
-		auto const edge_search = src_search->second.find(std::pair<N const*, E>({*dst_search, weight}));
-		if (edge_search == src_search->second.end()) {
-			src_search->second.emplace(*dst_search, weight);
-			return true;
+		return emplace_edge_ptr(src_entry, dst_entry, std::move(weight));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D, typename... Args>
+	requires std::constructible_from<E, Args...>
+	auto graph<N, E, Allocator, Storage>::emplace_edge(S const& src, D const& dst, Args&&... args)
+	   -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::emplace_edge when either src or "
+			                         "dst node does not exist");
+		}
+
+		return emplace_edge_ptr(src_entry, dst_entry, std::forward<Args>(args)...);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::ranges::input_range R>
+	requires std::convertible_to<std::ranges::range_reference_t<R>,
+	                             typename graph<N, E, Allocator, Storage>::value_type>
+	auto graph<N, E, Allocator, Storage>::insert_edges(R&& edges) -> std::size_t {
+		auto input = std::vector<value_type>{};
+		if constexpr (std::ranges::sized_range<R>) {
+			input.reserve(std::ranges::size(edges));
 		}
-		return false;
+		for (auto&& edge : edges) {
+			input.emplace_back(std::forward<decltype(edge)>(edge));
+		}
+
+		// Sorting the endpoints by value lets every distinct one be resolved, or created, in a
+		// single merge with nodes_rep_. Slot 2i holds edge i's source and slot 2i + 1 its
+		// destination.
+		auto endpoints = std::vector<std::pair<N const*, std::size_t>>{};
+		endpoints.reserve(2 * input.size());
+		for (auto i = std::size_t{0}; i < input.size(); i++) {
+			endpoints.emplace_back(&input[i].from, 2 * i);
+			endpoints.emplace_back(&input[i].to, 2 * i + 1);
+		}
+		std::sort(endpoints.begin(), endpoints.end(), [](auto const& lhs, auto const& rhs) {
+			return *lhs.first < *rhs.first;
+		});
+		auto slots = std::vector<node_entry const*>(endpoints.size());
+		auto node_iter = nodes_rep_.begin();
+		for (auto iter = endpoints.begin(); iter != endpoints.end();) {
+			auto const& value = *iter->first;
+			node_iter = detail::seek(
+			   node_iter,
+			   nodes_rep_.end(),
+			   [&](node_owner const& node) { return node->value < value; },
+			   [&] { return nodes_rep_.lower_bound(value); });
+			if (node_iter == nodes_rep_.end() || value < (*node_iter)->value) {
+				node_iter = link_node(node_iter, make_node(next_id(), value));
+			}
+			for (; iter != endpoints.end() && !(value < *iter->first); iter++) {
+				slots[iter->second] = node_iter->get();
+			}
+		}
+
+		// From here on nodes are only compared by rank.
+		auto pending = std::vector<pending_edge>{};
+		pending.reserve(input.size());
+		for (auto i = std::size_t{0}; i < input.size(); i++) {
+			pending.push_back({slots[2 * i], slots[2 * i + 1], std::move(input[i].weight)});
+		}
+		return insert_pending_edges(pending);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_pending_edges(std::vector<pending_edge>& pending)
+	   -> std::size_t {
+		auto const edge_less = [](pending_edge const& lhs, pending_edge const& rhs) {
+			if (lhs.src != rhs.src) {
+				return lhs.src->rank < rhs.src->rank;
+			}
+			if (lhs.dst != rhs.dst) {
+				return lhs.dst->rank < rhs.dst->rank;
+			}
+			return lhs.weight < rhs.weight;
+		};
+		std::sort(pending.begin(), pending.end(), edge_less);
+		auto const duplicates =
+		   std::unique(pending.begin(), pending.end(), [&](auto const& lhs, auto const& rhs) {
+			   return !edge_less(lhs, rhs) && !edge_less(rhs, lhs);
+		   });
+		pending.erase(duplicates, pending.end());
+
+		// The in-edge index needs each distinct (dst, src) pair, in dst order.
+		auto links = std::vector<std::pair<node_entry const*, node_entry const*>>{};
+		for (auto const& edge : pending) {
+			if (links.empty() || links.back().first != edge.dst || links.back().second != edge.src) {
+				links.emplace_back(edge.dst, edge.src);
+			}
+		}
+		std::sort(links.begin(), links.end(), [](auto const& lhs, auto const& rhs) {
+			if (lhs.first != rhs.first) {
+				return lhs.first->rank < rhs.first->rank;
+			}
+			return lhs.second->rank < rhs.second->rank;
+		});
+
+		auto inserted = std::size_t{0};
+		auto edges_iter = edges_rep_.begin();
+		for (auto iter = pending.begin(); iter != pending.end();) {
+			auto const src = iter->src;
+			edges_iter = detail::seek(
+			   edges_iter,
+			   edges_rep_.end(),
+			   [&](auto const& entry) { return entry.first->rank < src->rank; },
+			   [&] { return edges_rep_.lower_bound(src); });
+			if (edges_iter == edges_rep_.end() || edges_iter->first != src) {
+				edges_iter =
+				   edges_rep_.emplace_hint(edges_iter, src, edges_set_t(edges_rep_.get_allocator()));
+			}
+			// Each edge is hinted at the element after the one before it, which is where it goes
+			// unless src already has edges between them.
+			auto& src_edges = edges_iter->second;
+			auto hint = src_edges.lower_bound(iter->dst);
+			for (; iter != pending.end() && iter->src == src; iter++) {
+				auto const size_before = src_edges.size();
+				hint = std::next(src_edges.emplace_hint(hint, iter->dst, std::move(iter->weight)));
+				if (src_edges.size() != size_before) {
+					src->out_degree++;
+					iter->dst->in_degree++;
+					inserted++;
+				}
+			}
+		}
+		num_edges_ += inserted;
+
+		auto in_iter = in_edges_rep_.begin();
+		auto sources_hint = typename sources_set_t::const_iterator();
+		for (auto iter = links.begin(); iter != links.end(); iter++) {
+			auto const [dst, src] = *iter;
+			if (iter == links.begin() || std::prev(iter)->first != dst) {
+				in_iter = detail::seek(
+				   in_iter,
+				   in_edges_rep_.end(),
+				   [&](auto const& entry) { return entry.first->rank < dst->rank; },
+				   [&] { return in_edges_rep_.lower_bound(dst); });
+				if (in_iter == in_edges_rep_.end() || in_iter->first != dst) {
+					in_iter = in_edges_rep_.emplace_hint(in_iter,
+					                                     dst,
+					                                     sources_set_t(in_edges_rep_.get_allocator()));
+				}
+				sources_hint = in_iter->second.lower_bound(src);
+			}
+			sources_hint = std::next(in_iter->second.emplace_hint(sources_hint, src));
+		}
+		return inserted;
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::is_connected(N const& src, N const& dst) const -> bool {
-		if (!is_node(src) || !is_node(dst)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::is_connected(S const& src, D const& dst) const -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_ptr = find_entry(dst);
+		if (src_entry == nullptr || dst_ptr == nullptr) {
 			throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node "
 			                         "don't exist in the graph");
 		}
-		auto src_search = edges_rep_.find(&src);
-		if (src_search == edges_rep_.end()) {
-			return false;
+		return is_connected_ptr(src_entry, dst_ptr);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, std::ranges::input_range R>
+	requires detail::lookup_key<std::ranges::range_value_t<R>, N>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::is_connected_many(S const& src, R&& dsts) const
+	   -> std::vector<bool> {
+		auto const src_entry = find_entry(src);
+		if (src_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected_many if src doesn't "
+			                         "exist in the graph");
 		}
 
-		auto dst_search = nodes_rep_.find(&dst);
-		auto dst_ptr = *dst_search;
-		auto const& src_edges = src_search->second;
-		for (auto iter = src_edges.begin(); iter != src_edges.end(); iter++) {
-			if (iter->first == dst_ptr) {
-				return true;
+		auto result_vec = std::vector<bool>{};
+		if constexpr (std::ranges::sized_range<R>) {
+			result_vec.reserve(std::ranges::size(dsts));
+		}
+		auto const edges = edges_of(src_entry);
+		auto edge = edges.begin();
+		for (auto&& dst : dsts) {
+			while (edge != edges.end() && edge->first->value < dst) {
+				edge++;
 			}
+			result_vec.push_back(edge != edges.end() && !(dst < edge->first->value));
 		}
-		return false;
+		return result_vec;
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::nodes() const noexcept -> std::vector<N> {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::nodes() const noexcept -> std::vector<N> {
 		auto result_vec = std::vector<N>{};
 		for (auto iter = nodes_rep_.begin(); iter != nodes_rep_.end(); iter++) {
-			result_vec.emplace_back(**iter);
+			result_vec.emplace_back((*iter)->value);
 		}
 		return result_vec;
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::replace_node(N const& old_data, N const& new_data) -> bool {
-		if (!is_node(old_data)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	auto graph<N, E, Allocator, Storage>::replace_node(K const& old_data, N const& new_data)
+	   -> bool {
+		return replace_node_value(old_data, new_data);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	auto graph<N, E, Allocator, Storage>::replace_node(K const& old_data, N&& new_data) -> bool {
+		return replace_node_value(old_data, std::move(new_data));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename K, typename V>
+	auto graph<N, E, Allocator, Storage>::replace_node_value(K const& old_data, V&& new_data)
+	   -> bool {
+		auto const old_ptr = find_entry(old_data);
+		if (old_ptr == nullptr) {
 			throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node that "
 			                         "doesn't exist");
 		}
-		if (is_node(new_data)) {
+		auto const hint = nodes_rep_.lower_bound(new_data);
+		if (hint != nodes_rep_.end() && !(new_data < (*hint)->value)) {
 			return false;
 		}
 
-		auto const emplaced = node_u_ptrs_.emplace(std::make_unique<N>(new_data));
-		nodes_rep_.emplace((*(emplaced.first)).get());
+		auto const new_ptr =
+		   link_node(hint, make_node(next_id(), std::forward<V>(new_data)))->get();
 
-		auto old_data_search = edges_rep_.find(&old_data);
-		if (old_data_search != edges_rep_.end()) {
-			auto old_data_node = edges_rep_.extract(old_data_search->first);
-			old_data_node.key() = (*(emplaced.first)).get();
-			edges_rep_.insert(std::move(old_data_node));
+		new_ptr->out_degree = old_ptr->out_degree;
+		new_ptr->in_degree = old_ptr->in_degree;
+		auto out_node = edges_rep_.extract(old_ptr);
+		if (!out_node.empty()) {
+			out_node.key() = new_ptr;
+			edges_rep_.insert(std::move(out_node));
+		}
+		auto in_node = in_edges_rep_.extract(old_ptr);
+		if (!in_node.empty()) {
+			in_node.key() = new_ptr;
+			in_edges_rep_.insert(std::move(in_node));
 		}
 
-		auto old_nodes_rep_search = nodes_rep_.find(&old_data);
-
-		for (auto iter = edges_rep_.begin(); iter != edges_rep_.end(); iter++) {
-			auto& curr_edges = iter->second;
-			for (auto iter2 = curr_edges.begin(); iter2 != curr_edges.end();) {
-				if (*old_nodes_rep_search == iter2->first) {
-					auto const& weight = iter2->second;
-					auto extracted_edge = curr_edges.extract(iter2++);
-					extracted_edge.value() = std::pair<N const*, E>((*(emplaced.first)).get(), weight);
-					curr_edges.insert(std::move(extracted_edge));
+		// Only the sources listed in the incoming index hold edges that point at old_ptr.
+		auto const in_search = in_edges_rep_.find(new_ptr);
+		if (in_search != in_edges_rep_.end()) {
+			for (auto const src : in_search->second) {
+				auto& src_edges = edges_rep_.find(src == old_ptr ? new_ptr : src)->second;
+				auto const [first, last] = src_edges.equal_range(old_ptr);
+				auto moved_weights = std::vector<E>{};
+				for (auto iter = first; iter != last; iter++) {
+					moved_weights.emplace_back(iter->second);
 				}
-				else {
-					iter2++;
+				src_edges.erase(first, last);
+				for (auto& weight : moved_weights) {
+					src_edges.emplace(new_ptr, std::move(weight));
 				}
 			}
 		}
-		nodes_rep_.erase(old_nodes_rep_search);
-		for (auto iter = node_u_ptrs_.begin(); iter != node_u_ptrs_.end(); iter++) {
-			if (**iter == old_data) {
-				node_u_ptrs_.erase(iter);
-				break;
+
+		auto const out_search = edges_rep_.find(new_ptr);
+		if (out_search != edges_rep_.end()) {
+			auto const& out_edges = out_search->second;
+			for (auto iter = out_edges.begin(); iter != out_edges.end();
+			     iter = out_edges.upper_bound(iter->first)) {
+				auto& dst_sources = in_edges_rep_.find(iter->first)->second;
+				dst_sources.erase(old_ptr);
+				dst_sources.emplace(new_ptr);
 			}
 		}
+
+		erase_node_ptr(old_ptr);
 		return true;
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::merge_replace_node(N const& old_data, N const& new_data) -> void {
-		if (!is_node(old_data) || !is_node(new_data)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K1, detail::lookup_key<N> K2>
+	auto graph<N, E, Allocator, Storage>::merge_replace_node(K1 const& old_data, K2 const& new_data)
+	   -> void {
+		auto const old_ptr = find_entry(old_data);
+		auto const new_ptr = find_entry(new_data);
+		if (old_ptr == nullptr || new_ptr == nullptr) {
 			throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old or new "
 			                         "data if they don't exist in the graph");
 		}
 
-		auto old_nodes_rep_search = nodes_rep_.find(&old_data);
-		auto new_nodes_rep_search = nodes_rep_.find(&new_data);
+		if (old_ptr == new_ptr) {
+			return;
+		}
+
+		auto out_edges = std::vector<std::pair<node_entry const*, E>>{};
+		auto const out_search = edges_rep_.find(old_ptr);
+		if (out_search != edges_rep_.end()) {
+			out_edges.assign(out_search->second.begin(), out_search->second.end());
+		}
 
-		for (auto iter = edges_rep_.begin(); iter != edges_rep_.end(); iter++) {
-			auto& curr_edges = iter->second;
-			for (auto iter2 = curr_edges.begin(); iter2 != curr_edges.end();) {
-				if (*old_nodes_rep_search == iter2->first) {
-					auto const& weight = iter2->second;
-					auto extracted_edge = curr_edges.extract(iter2++);
-					extracted_edge.value() = std::pair<N const*, E>(*new_nodes_rep_search, weight);
-					curr_edges.insert(std::move(extracted_edge));
+		// Self-loops are already covered by out_edges.
+		auto in_edges = std::vector<std::pair<node_entry const*, E>>{};
+		auto const in_search = in_edges_rep_.find(old_ptr);
+		if (in_search != in_edges_rep_.end()) {
+			for (auto const src : in_search->second) {
+				if (src == old_ptr) {
+					continue;
 				}
-				else {
-					iter2++;
+				auto const& src_edges = edges_rep_.find(src)->second;
+				auto const [first, last] = src_edges.equal_range(old_ptr);
+				for (auto iter = first; iter != last; iter++) {
+					in_edges.emplace_back(src, iter->second);
 				}
 			}
 		}
 
-		auto old_data_search = edges_rep_.find(&old_data);
+		erase_incident_edges(old_ptr);
+		erase_node_ptr(old_ptr);
 
-		if (old_data_search != edges_rep_.end()) {
-			auto const& old_data_edges = old_data_search->second;
-			auto new_data_search = edges_rep_.find(&new_data);
-			if (new_data_search == edges_rep_.end()) {
-				auto const empty_edges = std::set<std::pair<N const*, E>, edge_compare>();
-				edges_rep_.emplace(*new_nodes_rep_search, empty_edges);
-				new_data_search = edges_rep_.find(&new_data);
-			}
-			auto& new_data_edges = new_data_search->second;
+		for (auto const& [dst, weight] : out_edges) {
+			emplace_edge_ptr(new_ptr, dst == old_ptr ? new_ptr : dst, weight);
+		}
+		for (auto const& [src, weight] : in_edges) {
+			emplace_edge_ptr(src, new_ptr, weight);
+		}
+	}
 
-			for (auto iter = old_data_edges.begin(); iter != old_data_edges.end(); iter++) {
-				if (!new_data_edges.contains(std::pair<N const*, E>(iter->first, iter->second))) {
-					insert_edge(*(new_data_search->first), *(iter->first), iter->second);
-				}
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::ranges::input_range R>
+	requires detail::lookup_key<
+	            std::remove_cvref_t<std::tuple_element_t<0, std::ranges::range_value_t<R>>>,
+	            N>
+	         and std::constructible_from<
+	            N,
+	            std::tuple_element_t<1, std::ranges::range_value_t<R>> const&>
+	auto graph<N, E, Allocator, Storage>::relabel(R&& mapping) -> std::size_t {
+		auto const alloc = rebind_alloc<N>(get_allocator());
+		auto listed = std::vector<std::pair<node_entry const*, N>>{};
+		for (auto&& entry : mapping) {
+			auto const& [old_value, new_value] = entry;
+			auto const old_ptr = find_entry(old_value);
+			if (old_ptr != nullptr) {
+				listed.emplace_back(old_ptr, std::make_obj_using_allocator<N>(alloc, new_value));
 			}
-			edges_rep_.erase(old_data_search);
 		}
-		nodes_rep_.erase(old_nodes_rep_search);
-		for (auto iter = node_u_ptrs_.begin(); iter != node_u_ptrs_.end(); iter++) {
-			if (**iter == old_data) {
-				node_u_ptrs_.erase(iter);
-				break;
+
+		// A key listed twice keeps its first new value. The rest stay in the mapping's order.
+		auto order = std::vector<std::size_t>(listed.size());
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+			return std::less<>()(listed[lhs].first, listed[rhs].first);
+		});
+		auto keep = std::vector<bool>(listed.size());
+		for (auto i = std::size_t{0}; i < order.size(); i++) {
+			keep[order[i]] = i == 0 || listed[order[i - 1]].first != listed[order[i]].first;
+		}
+		auto renames = std::vector<std::pair<node_entry const*, N>>{};
+		for (auto i = std::size_t{0}; i < listed.size(); i++) {
+			auto& [old_ptr, value] = listed[i];
+			if (keep[i] && (old_ptr->value < value || value < old_ptr->value)) {
+				renames.emplace_back(old_ptr, std::move(value));
 			}
 		}
+		return relabel_entries(renames);
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::erase_node(N const& value) -> bool {
-		if (!is_node(value)) {
-			return false;
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename F>
+	requires std::invocable<F&, N const&>
+	         and std::constructible_from<N, std::invoke_result_t<F&, N const&>>
+	auto graph<N, E, Allocator, Storage>::relabel(F f) -> std::size_t {
+		auto const alloc = rebind_alloc<N>(get_allocator());
+		auto renames = std::vector<std::pair<node_entry const*, N>>{};
+		for (auto const& node : nodes_rep_) {
+			auto value = std::make_obj_using_allocator<N>(alloc,
+			                                              std::invoke(f, std::as_const(node->value)));
+			if (node->value < value || value < node->value) {
+				renames.emplace_back(node.get(), std::move(value));
+			}
 		}
-		auto old_data_search = edges_rep_.find(&value);
-		if (old_data_search != edges_rep_.end()) {
-			edges_rep_.erase(old_data_search);
+		return relabel_entries(renames);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::ranges::input_range R>
+	requires detail::lookup_key<
+	            std::remove_cvref_t<std::tuple_element_t<0, std::ranges::range_value_t<R>>>,
+	            N>
+	         and detail::lookup_key<
+	            std::remove_cvref_t<std::tuple_element_t<1, std::ranges::range_value_t<R>>>,
+	            N>
+	auto graph<N, E, Allocator, Storage>::merge_replace_nodes(R&& pairs) -> std::size_t {
+		auto merges = std::vector<std::pair<node_entry const*, node_entry const*>>{};
+		for (auto&& pair : pairs) {
+			auto const& [old_data, new_data] = pair;
+			auto const old_ptr = find_entry(old_data);
+			auto const new_ptr = find_entry(new_data);
+			if (old_ptr == nullptr || new_ptr == nullptr) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_nodes on old or "
+				                         "new data if they don't exist in the graph");
+			}
+			merges.emplace_back(old_ptr, new_ptr);
 		}
-		auto value_nodes_rep_search = nodes_rep_.find(&value);
 
-		for (auto iter = edges_rep_.begin(); iter != edges_rep_.end();) {
-			auto& curr_edges = iter->second;
-			for (auto iter2 = curr_edges.begin(); iter2 != curr_edges.end();) {
-				if (*value_nodes_rep_search == iter2->first) {
-					curr_edges.erase(iter2++);
-				}
-				else {
-					iter2++;
-				}
+		// Each merged node's root is the node it ends up merged into. Roots are never chosen by
+		// size, as the pairs fix which node survives, so finds halve their paths to stay short.
+		// The union-find only covers the nodes the pairs name, known by their place in named.
+		auto named = std::vector<node_entry const*>{};
+		named.reserve(2 * merges.size());
+		for (auto const& [old_ptr, new_ptr] : merges) {
+			named.push_back(old_ptr);
+			named.push_back(new_ptr);
+		}
+		std::sort(named.begin(), named.end(), std::less<>());
+		named.erase(std::unique(named.begin(), named.end()), named.end());
+		auto const position_of = [&](node_entry const* entry) {
+			return static_cast<std::size_t>(
+			   std::lower_bound(named.begin(), named.end(), entry, std::less<>()) - named.begin());
+		};
+		auto parents = std::vector<std::size_t>(named.size());
+		std::iota(parents.begin(), parents.end(), std::size_t{0});
+		auto const find_root = [&](std::size_t position) {
+			while (parents[position] != position) {
+				parents[position] = parents[parents[position]];
+				position = parents[position];
+			}
+			return position;
+		};
+		auto doomed = std::vector<node_entry const*>{};
+		for (auto const& [old_ptr, new_ptr] : merges) {
+			auto const old_root = find_root(position_of(old_ptr));
+			auto const new_root = find_root(position_of(new_ptr));
+			if (old_root != new_root) {
+				parents[old_root] = new_root;
+				doomed.push_back(named[old_root]);
 			}
-			if (curr_edges.empty()) {
-				edges_rep_.erase(iter++);
+		}
+		if (doomed.empty()) {
+			return 0;
+		}
+
+		// The edges are copied out, pointing at the roots, before anything is erased.
+		std::sort(doomed.begin(), doomed.end(), std::less<>());
+		auto pending = std::vector<pending_edge>{};
+		collect_edges(doomed, pending);
+		auto const root_of = [&](node_entry const* entry) {
+			auto const position = position_of(entry);
+			return position != named.size() && named[position] == entry
+			          ? named[find_root(position)]
+			          : entry;
+		};
+		for (auto& edge : pending) {
+			edge.src = root_of(edge.src);
+			edge.dst = root_of(edge.dst);
+		}
+		erase_doomed_nodes(doomed);
+		insert_pending_edges(pending);
+		return doomed.size();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::relabel_entries(
+	   std::vector<std::pair<node_entry const*, N>>& renames) -> std::size_t {
+		if (renames.empty()) {
+			return 0;
+		}
+		// Every new value has been built by now, so the graph is unchanged if that threw. Merged
+		// nodes give their ids back, which has to be able to happen without allocating.
+		free_ids_.reserve(free_ids_.size() + renames.size());
+		auto renamed = std::vector<node_entry const*>{};
+		renamed.reserve(renames.size());
+		for (auto const& [entry, value] : renames) {
+			renamed.push_back(entry);
+		}
+		std::sort(renamed.begin(), renamed.end(), std::less<>());
+
+		// Detaches every edge touching a renamed node while ranks still match the containers.
+		auto pending = std::vector<pending_edge>{};
+		collect_edges(renamed, pending);
+		erase_edges_of(renamed);
+
+		// All renamed nodes leave nodes_rep_ before any returns, so that a node can take the old
+		// value of another. One that collides is merged into the node already holding its value,
+		// and stays allocated until its edges have been pointed at that node.
+		auto extracted = std::vector<typename nodes_set_t::node_type>{};
+		extracted.reserve(renames.size());
+		for (auto const& [entry, value] : renames) {
+			extracted.push_back(nodes_rep_.extract(nodes_rep_.find(entry->value)));
+		}
+		// survivors[i] is the node that renamed[i] ends up as.
+		auto const position_of = [&](node_entry const* entry) {
+			return static_cast<std::size_t>(
+			   std::lower_bound(renamed.begin(), renamed.end(), entry, std::less<>())
+			   - renamed.begin());
+		};
+		auto survivors = std::vector<node_entry const*>(renamed.size());
+		auto merged = std::vector<typename nodes_set_t::node_type>{};
+		for (auto i = std::size_t{0}; i < renames.size(); i++) {
+			auto& node = extracted[i];
+			node.value()->value = std::move(renames[i].second);
+			auto const id = node.value()->id;
+			auto const position = position_of(renames[i].first);
+			auto result = nodes_rep_.insert(std::move(node));
+			survivors[position] = result.position->get();
+			if (result.inserted) {
+				assign_rank(result.position);
 			}
 			else {
-				iter++;
+				free_ids_.push_back(id);
+				merged.push_back(std::move(result.node));
 			}
 		}
-		nodes_rep_.erase(value_nodes_rep_search);
-		for (auto iter = node_u_ptrs_.begin(); iter != node_u_ptrs_.end(); iter++) {
-			if (**iter == value) {
-				node_u_ptrs_.erase(iter);
-				break;
-			}
+
+		auto const survivor_of = [&](node_entry const* entry) {
+			auto const position = position_of(entry);
+			return position != renamed.size() && renamed[position] == entry ? survivors[position]
+			                                                                 : entry;
+		};
+		for (auto& edge : pending) {
+			edge.src = survivor_of(edge.src);
+			edge.dst = survivor_of(edge.dst);
+		}
+		insert_pending_edges(pending);
+		return renames.size();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	auto graph<N, E, Allocator, Storage>::erase_node(K const& value) -> bool {
+		auto const value_ptr = find_entry(value);
+		if (value_ptr == nullptr) {
+			return false;
 		}
+		erase_incident_edges(value_ptr);
+		erase_node_ptr(value_ptr);
 		return true;
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::erase_edge(N const& src, N const& dst, E const& weight) -> bool {
-		if (!is_node(src) || !is_node(dst)) {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	auto graph<N, E, Allocator, Storage>::erase_edge(S const& src, D const& dst, E const& weight)
+	   -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
 			throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they "
 			                         "don't exist in the graph");
 		}
-		auto iter = find(src, dst, weight);
+		auto iter = find_ptr(src_entry, dst_entry, weight);
 		if (iter == end()) {
 			return false;
 		}
@@ -492,79 +1544,384 @@ namespace gdwg {
 		return true;
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::clear() noexcept -> void {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::clear() noexcept -> void {
 		edges_rep_.clear();
+		in_edges_rep_.clear();
 		nodes_rep_.clear();
-		node_u_ptrs_.clear();
+		free_ids_.clear();
+		id_bound_ = 0;
+		num_edges_ = 0;
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::weights(N const& src, N const& dst) const -> std::vector<E> {
-		if (!is_node(src) || !is_node(dst)) {
-			throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node don't "
-			                         "exist in the graph");
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::merge(graph<N, E, Allocator, Storage>& other) -> void {
+		if (this == &other) {
+			return;
 		}
-
-		auto result_vec = std::vector<E>{};
-
-		auto src_search = edges_rep_.find(&src);
-		if (src_search == edges_rep_.end()) {
-			return result_vec;
+		// Nothing of other's can be relinked here, so it is copied into this graph's allocator
+		// first, and what that copy keeps back is what other keeps.
+		if (get_allocator() != other.get_allocator()) {
+			auto local = graph<N, E, Allocator, Storage>(other, get_allocator());
+			merge(local);
+			other = std::move(local);
+			return;
 		}
-		auto dst_search = nodes_rep_.find(&dst);
-		auto dst_ptr = *dst_search;
-		auto const& src_edges = src_search->second;
 
-		for (auto iter = src_edges.begin(); iter != src_edges.end(); iter++) {
-			if (iter->first == dst_ptr) {
-				result_vec.emplace_back(iter->second);
+		// Each node of other either matches one here, its target, or is moved over.
+		auto targets = std::vector<node_entry const*>(other.id_bound_);
+		auto moved_nodes = std::vector<std::pair<typename nodes_set_t::const_iterator,
+		                                         typename nodes_set_t::const_iterator>>{};
+		auto node_iter = nodes_rep_.begin();
+		for (auto iter = other.nodes_rep_.begin(); iter != other.nodes_rep_.end(); iter++) {
+			auto const& value = (*iter)->value;
+			while (node_iter != nodes_rep_.end() && (*node_iter)->value < value) {
+				node_iter++;
+			}
+			if (node_iter != nodes_rep_.end() && !(value < (*node_iter)->value)) {
+				targets[(*iter)->id] = node_iter->get();
+			}
+			else {
+				moved_nodes.emplace_back(iter, node_iter);
 			}
 		}
-		return result_vec;
-	}
-
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::connections(N const& src) const -> std::vector<N> {
-		if (!is_node(src)) {
-			throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist "
-			                         "in the graph");
-		}
-
-		auto result_vec = std::vector<N>{};
-
-		auto src_search = edges_rep_.find(&src);
-		if (src_search == edges_rep_.end()) {
-			return result_vec;
-		}
-
-		auto const& src_edges = src_search->second;
-
-		auto prev = src_edges.begin()->first;
+		auto const target_of = [&](node_entry const* entry) {
+			return targets[entry->id] == nullptr ? entry : targets[entry->id];
+		};
 
-		for (auto iter = src_edges.begin(); iter != src_edges.end(); iter++) {
-			if (result_vec.empty()) {
-				result_vec.emplace_back(*(iter->first));
+		// Every edge that this graph lacks is extracted from other and kept aside, already
+		// pointing at its destination here. The rest stay where they are, so a set that is a
+		// tree under flat_storage stays one. Both graphs' ranks are still their own, so other's
+		// containers stay ordered throughout.
+		struct moved_edge {
+			node_entry const* src;
+			typename edges_set_t::node_type node;
+		};
+		auto moved_edges = std::vector<moved_edge>{};
+		auto spare_edge_maps = std::vector<typename edges_map_t::node_type>{};
+		for (auto map_iter = other.edges_rep_.begin(); map_iter != other.edges_rep_.end();) {
+			auto const src = map_iter->first;
+			auto& src_edges = map_iter->second;
+			for (auto iter = src_edges.begin(); iter != src_edges.end();) {
+				if (targets[src->id] != nullptr && targets[iter->first->id] != nullptr
+				    && find_ptr(targets[src->id], targets[iter->first->id], iter->second) != end())
+				{
+					iter++;
+					continue;
+				}
+				auto node = src_edges.extract(iter);
+				iter = src_edges.upper_bound(node.value());
+				auto& dst = node.value().first;
+				src->out_degree--;
+				dst->in_degree--;
+				dst = target_of(dst);
+				moved_edges.push_back({target_of(src), std::move(node)});
+			}
+			if (src_edges.empty()) {
+				auto const next = std::next(map_iter);
+				spare_edge_maps.push_back(other.edges_rep_.extract(map_iter));
+				map_iter = next;
 			}
 			else {
-				if (iter->first != prev) {
-					result_vec.emplace_back(*(iter->first));
-				}
+				map_iter++;
 			}
-			prev = iter->first;
 		}
-		return result_vec;
+		other.num_edges_ -= moved_edges.size();
+
+		// other's in-edge index then only keeps sources that still have an edge to each node.
+		auto spare_source_maps = std::vector<typename sources_map_t::node_type>{};
+		auto spare_sources = std::vector<typename sources_set_t::node_type>{};
+		for (auto map_iter = other.in_edges_rep_.begin(); map_iter != other.in_edges_rep_.end();) {
+			auto const dst = map_iter->first;
+			auto& dst_sources = map_iter->second;
+			for (auto iter = dst_sources.begin(); iter != dst_sources.end();) {
+				if (other.is_connected_ptr(*iter, dst)) {
+					iter++;
+					continue;
+				}
+				auto node = dst_sources.extract(iter);
+				iter = dst_sources.upper_bound(node.value());
+				spare_sources.push_back(std::move(node));
+			}
+			if (dst_sources.empty()) {
+				auto const next = std::next(map_iter);
+				spare_source_maps.push_back(other.in_edges_rep_.extract(map_iter));
+				map_iter = next;
+			}
+			else {
+				map_iter++;
+			}
+		}
+
+		// No container of other refers to the moved nodes any more, so they can take ids and
+		// ranks here. Each hint is the node here that follows it, and none of those has moved.
+		other.free_ids_.reserve(other.free_ids_.size() + moved_nodes.size());
+		for (auto const& [iter, hint] : moved_nodes) {
+			other.free_ids_.push_back((*iter)->id);
+			link_node(hint, other.nodes_rep_.extract(iter));
+		}
+
+		// Each source's moved edges arrive together and in destination order.
+		auto links = std::vector<std::pair<node_entry const*, node_entry const*>>{};
+		auto map_iter = edges_rep_.end();
+		for (auto& [src, node] : moved_edges) {
+			if (map_iter == edges_rep_.end() || map_iter->first != src) {
+				map_iter = edges_rep_.find(src);
+				if (map_iter == edges_rep_.end() && !spare_edge_maps.empty()) {
+					auto spare = std::move(spare_edge_maps.back());
+					spare_edge_maps.pop_back();
+					spare.key() = src;
+					map_iter = edges_rep_.insert(std::move(spare)).position;
+				}
+				else if (map_iter == edges_rep_.end()) {
+					map_iter =
+					   edges_rep_.try_emplace(src, edges_set_t(edges_rep_.get_allocator())).first;
+				}
+			}
+			auto const dst = node.value().first;
+			map_iter->second.insert(std::move(node));
+			src->out_degree++;
+			dst->in_degree++;
+			if (links.empty() || links.back().first != dst || links.back().second != src) {
+				links.emplace_back(dst, src);
+			}
+		}
+		num_edges_ += moved_edges.size();
+
+		for (auto const& [dst, src] : links) {
+			auto in_iter = in_edges_rep_.find(dst);
+			if (in_iter == in_edges_rep_.end() && !spare_source_maps.empty()) {
+				auto spare = std::move(spare_source_maps.back());
+				spare_source_maps.pop_back();
+				spare.key() = dst;
+				in_iter = in_edges_rep_.insert(std::move(spare)).position;
+			}
+			else if (in_iter == in_edges_rep_.end()) {
+				in_iter = in_edges_rep_
+				             .try_emplace(dst, sources_set_t(in_edges_rep_.get_allocator()))
+				             .first;
+			}
+			auto& dst_sources = in_iter->second;
+			if (dst_sources.contains(src)) {
+				continue;
+			}
+			if (!spare_sources.empty()) {
+				auto spare = std::move(spare_sources.back());
+				spare_sources.pop_back();
+				spare.value() = src;
+				dst_sources.insert(std::move(spare));
+			}
+			else {
+				dst_sources.emplace(src);
+			}
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::merge(graph<N, E, Allocator, Storage>&& other) -> void {
+		merge(other);
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::operator==(graph<N, E> const& other) const noexcept -> bool {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::weights(S const& src, D const& dst) const
+	   -> std::vector<E> {
+		auto const src_entry = find_entry(src);
+		auto const dst_ptr = find_entry(dst);
+		if (src_entry == nullptr || dst_ptr == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node don't "
+			                         "exist in the graph");
+		}
+		return weights_ptr(src_entry, dst_ptr);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::connections(K const& src) const
+	   -> std::vector<N> {
+		auto const src_entry = find_entry(src);
+		if (src_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't exist "
+			                         "in the graph");
+		}
+
+		auto result_vec = std::vector<N>{};
+
+		auto src_search = edges_rep_.find(src_entry);
+		if (src_search == edges_rep_.end()) {
+			return result_vec;
+		}
+
+		auto const& src_edges = src_search->second;
+
+		auto prev = src_edges.begin()->first;
+
+		for (auto iter = src_edges.begin(); iter != src_edges.end(); iter++) {
+			if (result_vec.empty()) {
+				result_vec.emplace_back(iter->first->value);
+			}
+			else {
+				if (iter->first != prev) {
+					result_vec.emplace_back(iter->first->value);
+				}
+			}
+			prev = iter->first;
+		}
+		return result_vec;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::nodes_view() const {
+		return std::ranges::transform_view(std::views::all(nodes_rep_), node_value_fn{});
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::out_edges(K const& src) const {
+		auto const src_entry = find_entry(src);
+		if (src_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_edges if src doesn't exist "
+			                         "in the graph");
+		}
+		return std::ranges::transform_view(edges_of(src_entry), edge_ref_fn{});
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::connections_view(K const& src) const {
+		auto const src_entry = find_entry(src);
+		if (src_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections_view if src doesn't "
+			                         "exist in the graph");
+		}
+		auto const edges = edges_of(src_entry);
+		return std::ranges::subrange(dst_iterator(edges.begin(), edges.end()),
+		                             dst_iterator(edges.end(), edges.end()));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::weights_view(S const& src, D const& dst) const {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights_view if src or dst node "
+			                         "don't exist in the graph");
+		}
+		auto range = std::ranges::subrange<edges_set_iter_t>();
+		auto const src_search = edges_rep_.find(src_entry);
+		if (src_search != edges_rep_.end()) {
+			auto const [first, last] = src_search->second.equal_range(dst_entry);
+			range = std::ranges::subrange(first, last);
+		}
+		return std::ranges::elements_view<std::ranges::subrange<edges_set_iter_t>, 1>(range);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename F>
+	requires std::invocable<F&, N const&>
+	auto graph<N, E, Allocator, Storage>::for_each_node(F&& f) const -> bool {
+		for (auto const& node : nodes_rep_) {
+			if (!visit(f, node->value)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename F>
+	requires std::invocable<F&, N const&, N const&, E const&>
+	auto graph<N, E, Allocator, Storage>::for_each_edge(F&& f) const -> bool {
+		for (auto const& [src, src_edges] : edges_rep_) {
+			for (auto const& [dst, weight] : src_edges) {
+				if (!visit(f, src->value, dst->value, weight)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> K, typename F>
+	requires std::invocable<F&, N const&, E const&>
+	auto graph<N, E, Allocator, Storage>::for_each_out_edge(K const& src, F&& f) const -> bool {
+		auto const src_entry = find_entry(src);
+		if (src_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::for_each_out_edge if src doesn't "
+			                         "exist in the graph");
+		}
+		for (auto const& [dst, weight] : edges_of(src_entry)) {
+			if (!visit(f, dst->value, weight)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename F>
+	requires std::invocable<F&, N const&, N const&, E const&>
+	auto graph<N, E, Allocator, Storage>::parallel_for_each_edge(F&& f, unsigned num_threads) const
+	   -> void {
+		auto const bounds = partition_sources(num_threads);
+		auto work = [&](std::size_t run) {
+			for (auto iter = bounds[run]; iter != bounds[run + 1]; iter++) {
+				for (auto const& [dst, weight] : iter->second) {
+					std::invoke(f, iter->first->value, dst->value, weight);
+				}
+			}
+		};
+		run_in_parallel(bounds.size() - 1, work);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename T, typename Reduce, typename Transform>
+	requires std::invocable<Transform&, N const&, N const&, E const&>
+	         and std::convertible_to<std::invoke_result_t<Reduce&, T, T>, T>
+	auto graph<N, E, Allocator, Storage>::parallel_reduce_edges(T init,
+	                                                            Reduce reduce,
+	                                                            Transform transform,
+	                                                            unsigned num_threads) const -> T {
+		auto const bounds = partition_sources(num_threads);
+		auto partials = std::vector<std::optional<T>>(bounds.size() - 1);
+		auto work = [&](std::size_t run) {
+			auto& partial = partials[run];
+			for (auto iter = bounds[run]; iter != bounds[run + 1]; iter++) {
+				for (auto const& [dst, weight] : iter->second) {
+					auto value = T(std::invoke(transform, iter->first->value, dst->value, weight));
+					if (partial) {
+						partial = std::invoke(reduce, std::move(*partial), std::move(value));
+					}
+					else {
+						partial.emplace(std::move(value));
+					}
+				}
+			}
+		};
+		run_in_parallel(partials.size(), work);
+
+		for (auto& partial : partials) {
+			if (partial) {
+				init = std::invoke(reduce, std::move(init), std::move(*partial));
+			}
+		}
+		return init;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::operator==(graph<N, E, Allocator, Storage> const& other) const
+	   noexcept -> bool {
 		if (edges_rep_.size() != other.edges_rep_.size()
 		    || nodes_rep_.size() != other.nodes_rep_.size()) {
 			return false;
 		}
 		auto other_node_iter = other.nodes_rep_.begin();
 		for (auto node_iter = nodes_rep_.begin(); node_iter != nodes_rep_.end(); node_iter++) {
-			if (**node_iter != **other_node_iter) {
+			if ((*node_iter)->value != (*other_node_iter)->value) {
 				return false;
 			}
 			other_node_iter++;
@@ -572,7 +1929,7 @@ namespace gdwg {
 
 		auto other_iter = other.edges_rep_.begin();
 		for (auto iter = edges_rep_.begin(); iter != edges_rep_.end(); iter++) {
-			if (*(iter->first) != *(other_iter->first)) {
+			if (iter->first->value != other_iter->first->value) {
 				return false;
 			}
 			auto const& edges = iter->second;
@@ -582,7 +1939,7 @@ namespace gdwg {
 			}
 			auto other_edge_iter = other_edges.begin();
 			for (auto edge_iter = edges.begin(); edge_iter != edges.end(); edge_iter++) {
-				if (*(edge_iter->first) != *(other_edge_iter->first)
+				if (edge_iter->first->value != other_edge_iter->first->value
 				    || edge_iter->second != other_edge_iter->second)
 				{
 					return false;
@@ -594,32 +1951,568 @@ namespace gdwg {
 		return true;
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::begin() const noexcept -> iterator {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::begin() const noexcept -> iterator {
 		return iterator(edges_rep_);
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::end() const noexcept -> iterator {
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::end() const noexcept -> iterator {
 		return iterator(edges_rep_, true);
 	}
 
-	template<typename N, typename E>
-	[[nodiscard]] auto graph<N, E>::find(N const& src, N const& dst, E const& weight) const
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::find(S const& src, D const& dst, E const& weight) const
 	   -> iterator {
-		auto src_search = edges_rep_.find(&src);
+		return find_ptr(find_entry(src), find_entry(dst), weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_edge(iterator i) -> iterator {
+		auto const map_iter = edges_rep_.erase(i.curr_map_iter_, i.curr_map_iter_);
+		auto& src_edges = map_iter->second;
+		auto const dst = i.curr_set_iter_->first;
+		// The successor has to come from the set's erase, as flat storage shifts the later edges.
+		auto const next = src_edges.erase(i.curr_set_iter_);
+		map_iter->first->out_degree--;
+		dst->in_degree--;
+		num_edges_--;
+		if (!src_edges.contains(dst)) {
+			unlink_source(map_iter->first, dst);
+		}
+		return iterator_at(map_iter, next);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_edge(iterator i, iterator s) -> iterator {
+		auto iter = i;
+		while (iter != s) {
+			auto const map_iter = edges_rep_.erase(iter.curr_map_iter_, iter.curr_map_iter_);
+			auto& src_edges = map_iter->second;
+			// Each source's part of the range is erased in one go. That erase may invalidate s if
+			// it points into the same set, so the loop ends there rather than comparing with s.
+			auto const ends_here = (s.curr_map_iter_ == iter.curr_map_iter_);
+			auto const last = ends_here ? s.curr_set_iter_ : src_edges.end();
+
+			auto dsts = std::vector<node_entry const*>{};
+			auto count = std::size_t{0};
+			for (auto edge = iter.curr_set_iter_; edge != last; edge++) {
+				if (dsts.empty() || dsts.back() != edge->first) {
+					dsts.emplace_back(edge->first);
+				}
+				edge->first->in_degree--;
+				count++;
+			}
+			auto const next = src_edges.erase(iter.curr_set_iter_, last);
+			map_iter->first->out_degree -= count;
+			num_edges_ -= count;
+			for (auto const dst : dsts) {
+				if (!src_edges.contains(dst)) {
+					unlink_source(map_iter->first, dst);
+				}
+			}
+
+			iter = iterator_at(map_iter, next);
+			if (ends_here) {
+				break;
+			}
+		}
+		return iter;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	auto graph<N, E, Allocator, Storage>::extract_edge(S const& src, D const& dst, E const& weight)
+	   -> extracted_edge {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::extract_edge on src or dst if "
+			                         "they don't exist in the graph");
+		}
+		auto const iter = find_ptr(src_entry, dst_entry, weight);
+		if (iter == end()) {
+			return extracted_edge();
+		}
+		return extract_edge(iter);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::extract_edge(iterator i) -> extracted_edge {
+		auto const map_iter = edges_rep_.erase(i.curr_map_iter_, i.curr_map_iter_);
+		auto& src_edges = map_iter->second;
+		auto const src = map_iter->first;
+		auto const dst = i.curr_set_iter_->first;
+		auto edge = extracted_edge(src, src_edges.extract(i.curr_set_iter_));
+		src->out_degree--;
+		dst->in_degree--;
+		num_edges_--;
+		if (!src_edges.contains(dst)) {
+			unlink_source(src, dst);
+		}
+		if (src_edges.empty()) {
+			edges_rep_.erase(map_iter);
+		}
+		return edge;
+	}
 
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_edge(extracted_edge&& edge) -> bool {
+		if (edge.empty()) {
+			return false;
+		}
+		auto const src = find_entry(edge.from());
+		auto const dst = find_entry(edge.to());
+		if (src == nullptr || dst == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or "
+			                         "dst node does not exist");
+		}
+
+		auto& value = edge.node_.value();
+		auto const old_dst = std::exchange(value.first, dst);
+		auto const src_search =
+		   edges_rep_.try_emplace(src, edges_set_t(edges_rep_.get_allocator())).first;
+		auto& src_edges = src_search->second;
+		// A node can only be linked into a set with an equal allocator, so any other edge is moved
+		// into a node of this graph's.
+		auto inserted = false;
+		if (edge.node_.get_allocator() == src_edges.get_allocator()) {
+			auto result = src_edges.insert(std::move(edge.node_));
+			inserted = result.inserted;
+			edge.node_ = std::move(result.node);
+		}
+		else if (!src_edges.contains(value)) {
+			src_edges.emplace(std::move(value));
+			edge.node_ = typename edges_set_t::node_type();
+			inserted = true;
+		}
+		if (!inserted) {
+			edge.node_.value().first = old_dst;
+			if (src_edges.empty()) {
+				edges_rep_.erase(src_search);
+			}
+			return false;
+		}
+
+		// std::set::emplace allocates before it finds a duplicate, so src is looked up first.
+		auto& dst_sources =
+		   in_edges_rep_.try_emplace(dst, sources_set_t(in_edges_rep_.get_allocator())).first->second;
+		if (!dst_sources.contains(src)) {
+			dst_sources.emplace(src);
+		}
+		src->out_degree++;
+		dst->in_degree++;
+		num_edges_++;
+		edge.src_ = nullptr;
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<detail::lookup_key<N> S, detail::lookup_key<N> D>
+	auto graph<N, E, Allocator, Storage>::update_weight(S const& src,
+	                                                    D const& dst,
+	                                                    E const& old_weight,
+	                                                    E const& new_weight) -> bool {
+		auto const src_entry = find_entry(src);
+		auto const dst_entry = find_entry(dst);
+		if (src_entry == nullptr || dst_entry == nullptr) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::update_weight on src or dst if "
+			                         "they don't exist in the graph");
+		}
+		return update_weight_ptr(src_entry, dst_entry, old_weight, new_weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename Pred>
+	requires std::predicate<Pred&, N const&, N const&, E const&>
+	auto graph<N, E, Allocator, Storage>::erase_edges_if(Pred pred) -> std::size_t {
+		return erase_edges_where(
+		   [&](node_entry const* src, node_entry const* dst, E const& weight) -> bool {
+			   return std::invoke(pred, src->value, dst->value, weight);
+		   });
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename Pred>
+	requires std::predicate<Pred&, N const&>
+	auto graph<N, E, Allocator, Storage>::erase_nodes_if(Pred pred) -> std::size_t {
+		auto doomed = std::vector<node_entry const*>{};
+		for (auto const& node : nodes_rep_) {
+			if (std::invoke(pred, std::as_const(node->value))) {
+				doomed.push_back(node.get());
+			}
+		}
+		erase_doomed_nodes(doomed);
+		return doomed.size();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::input_iterator InputIt>
+	requires detail::lookup_key<std::iter_value_t<InputIt>, N>
+	auto graph<N, E, Allocator, Storage>::erase_nodes(InputIt first, InputIt last) -> std::size_t {
+		return erase_nodes(std::ranges::subrange(std::move(first), std::move(last)));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<std::ranges::input_range R>
+	requires detail::lookup_key<std::ranges::range_value_t<R>, N>
+	auto graph<N, E, Allocator, Storage>::erase_nodes(R&& values) -> std::size_t {
+		auto doomed = std::vector<node_entry const*>{};
+		for (auto&& value : values) {
+			auto const entry = find_entry(value);
+			if (entry != nullptr) {
+				doomed.push_back(entry);
+			}
+		}
+		std::sort(doomed.begin(), doomed.end(), std::less<>());
+		doomed.erase(std::unique(doomed.begin(), doomed.end()), doomed.end());
+		erase_doomed_nodes(doomed);
+		return doomed.size();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::freeze() const -> csr_graph<N, E> {
+		// Maps each node's id to its position in value order.
+		auto indices = std::vector<std::uint32_t>(id_bound_);
+		auto nodes = std::vector<N>{};
+		nodes.reserve(nodes_rep_.size());
+		for (auto const& node : nodes_rep_) {
+			indices[node->id] = static_cast<std::uint32_t>(nodes.size());
+			nodes.emplace_back(node->value);
+		}
+
+		auto num_edges = std::size_t{0};
+		for (auto const& [src, src_edges] : edges_rep_) {
+			num_edges += src_edges.size();
+		}
+		auto offsets = std::vector<std::size_t>{};
+		offsets.reserve(nodes_rep_.size() + 1);
+		offsets.emplace_back(0);
+		auto dsts = std::vector<std::uint32_t>{};
+		dsts.reserve(num_edges);
+		auto weights = std::vector<E>{};
+		weights.reserve(num_edges);
+
+		auto edges_iter = edges_rep_.begin();
+		for (auto const& node : nodes_rep_) {
+			if (edges_iter != edges_rep_.end() && edges_iter->first == node.get()) {
+				for (auto const& [dst, weight] : edges_iter->second) {
+					dsts.emplace_back(indices[dst->id]);
+					weights.emplace_back(weight);
+				}
+				edges_iter++;
+			}
+			offsets.emplace_back(dsts.size());
+		}
+
+		return csr_graph<N, E>(std::move(nodes),
+		                       std::move(offsets),
+		                       std::move(dsts),
+		                       std::move(weights));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_edge(node_handle src,
+	                                                  node_handle dst,
+	                                                  E const& weight) -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or "
+			                         "dst node does not exist");
+		}
+		return emplace_edge_ptr(src.entry_, dst.entry_, weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::insert_edge(node_handle src, node_handle dst, E&& weight)
+	   -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src or "
+			                         "dst node does not exist");
+		}
+		return emplace_edge_ptr(src.entry_, dst.entry_, std::move(weight));
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename... Args>
+	requires std::constructible_from<E, Args...>
+	auto graph<N, E, Allocator, Storage>::emplace_edge(node_handle src,
+	                                                   node_handle dst,
+	                                                   Args&&... args) -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::emplace_edge when either src or "
+			                         "dst node does not exist");
+		}
+		return emplace_edge_ptr(src.entry_, dst.entry_, std::forward<Args>(args)...);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::is_connected(node_handle src,
+	                                                                 node_handle dst) const -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst node "
+			                         "don't exist in the graph");
+		}
+		return is_connected_ptr(src.entry_, dst.entry_);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::weights(node_handle src,
+	                                                            node_handle dst) const
+	   -> std::vector<E> {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node don't "
+			                         "exist in the graph");
+		}
+		return weights_ptr(src.entry_, dst.entry_);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto
+	graph<N, E, Allocator, Storage>::find(node_handle src, node_handle dst, E const& weight) const
+	   -> iterator {
+		return find_ptr(src.entry_, dst.entry_, weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_edge(node_handle src,
+	                                                 node_handle dst,
+	                                                 E const& weight) -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they "
+			                         "don't exist in the graph");
+		}
+		auto iter = find_ptr(src.entry_, dst.entry_, weight);
+		if (iter == end()) {
+			return false;
+		}
+		erase_edge(iter);
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::update_weight(node_handle src,
+	                                                    node_handle dst,
+	                                                    E const& old_weight,
+	                                                    E const& new_weight) -> bool {
+		if (!src || !dst) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::update_weight on src or dst if "
+			                         "they don't exist in the graph");
+		}
+		return update_weight_ptr(src.entry_, dst.entry_, old_weight, new_weight);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::out_degree(node_handle node) const
+	   -> std::size_t {
+		if (!node) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_degree on a node that "
+			                         "doesn't exist");
+		}
+		return node.entry_->out_degree;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	[[nodiscard]] auto graph<N, E, Allocator, Storage>::in_degree(node_handle node) const
+	   -> std::size_t {
+		if (!node) {
+			throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_degree on a node that "
+			                         "doesn't exist");
+		}
+		return node.entry_->in_degree;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename K>
+	auto graph<N, E, Allocator, Storage>::find_entry(K const& value) const -> node_entry const* {
+		auto const search = nodes_rep_.find(value);
+		return search == nodes_rep_.end() ? nullptr : search->get();
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::next_id() const -> std::uint32_t {
+		if (!free_ids_.empty()) {
+			return free_ids_.back();
+		}
+		if (id_bound_ == std::numeric_limits<std::uint32_t>::max()) {
+			throw std::length_error("Cannot give a gdwg::graph<N, E> more than 2^32 - 1 nodes");
+		}
+		return id_bound_;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename... Args>
+	auto graph<N, E, Allocator, Storage>::make_node(std::uint32_t id, Args&&... args) -> node_owner {
+		auto alloc = rebind_alloc<node_entry>(nodes_rep_.get_allocator());
+		auto const entry = entry_alloc_traits::allocate(alloc, 1);
+		try {
+			entry_alloc_traits::construct(alloc,
+			                              entry,
+			                              id,
+			                              rebind_alloc<N>(alloc),
+			                              std::forward<Args>(args)...);
+		} catch (...) {
+			entry_alloc_traits::deallocate(alloc, entry, 1);
+			throw;
+		}
+		return node_owner(entry, node_deleter{alloc});
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::link_node(typename nodes_set_t::const_iterator hint,
+	                                                node_owner owner)
+	   -> typename nodes_set_t::iterator {
+		auto const iter = nodes_rep_.emplace_hint(hint, std::move(owner));
+		// The owner's id came from next_id(), which is now taken.
+		if (free_ids_.empty()) {
+			id_bound_++;
+		}
+		else {
+			free_ids_.pop_back();
+		}
+		assign_rank(iter);
+		return iter;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::link_node(typename nodes_set_t::const_iterator hint,
+	                                                typename nodes_set_t::node_type node)
+	   -> typename nodes_set_t::iterator {
+		node.value()->id = next_id();
+		auto const iter = nodes_rep_.insert(hint, std::move(node));
+		if (free_ids_.empty()) {
+			id_bound_++;
+		}
+		else {
+			free_ids_.pop_back();
+		}
+		assign_rank(iter);
+		return iter;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::assign_rank(typename nodes_set_t::iterator iter) -> void {
+		constexpr auto max_rank = std::numeric_limits<rank_t>::max();
+		// Keeps ranks clear of 0 and max_rank, which stand for the ends of the node order. Nodes
+		// added past either end step away from their neighbour rather than halving the gap, so
+		// that inserting nodes in order does not use the gap up after 64 of them.
+		constexpr auto end_step = rank_t{1} << 32U;
+		auto const next = std::next(iter);
+		auto const lower = iter == nodes_rep_.begin() ? rank_t{0} : (*std::prev(iter))->rank;
+		auto const upper = next == nodes_rep_.end() ? max_rank : (*next)->rank;
+		if (upper - lower > 1) {
+			auto const half = (upper - lower) / 2;
+			if (next == nodes_rep_.end()) {
+				(*iter)->rank = lower + std::min(half, end_step);
+			}
+			else if (iter == nodes_rep_.begin()) {
+				(*iter)->rank = upper - std::min(half, end_step);
+			}
+			else {
+				(*iter)->rank = lower + half;
+			}
+			return;
+		}
+
+		// There is no room between the neighbours, so the ranks of a window of nodes around iter
+		// are spread out evenly. The window keeps growing until that leaves a gap wider than the
+		// window, which keeps the cost amortised. Relative order is kept, so no container has to
+		// re-sort.
+		auto first = iter;
+		auto last = next;
+		auto count = rank_t{1};
+		auto window_lower = lower;
+		auto window_upper = upper;
+		while ((window_upper - window_lower) / (count + 1) <= count) {
+			for (auto grow = count; grow > 0; grow--) {
+				if (first != nodes_rep_.begin()) {
+					first--;
+					count++;
+				}
+				if (last != nodes_rep_.end()) {
+					last++;
+					count++;
+				}
+			}
+			window_lower = first == nodes_rep_.begin() ? rank_t{0} : (*std::prev(first))->rank;
+			window_upper = last == nodes_rep_.end() ? max_rank : (*last)->rank;
+		}
+		auto const gap = (window_upper - window_lower) / (count + 1);
+		auto rank = window_lower;
+		for (auto node = first; node != last; node++) {
+			rank += gap;
+			(*node)->rank = rank;
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename... Args>
+	auto graph<N, E, Allocator, Storage>::emplace_edge_ptr(node_entry const* src,
+	                                                       node_entry const* dst,
+	                                                       Args&&... args) -> bool {
+		// The empty containers are passed in so that they pick up the graph's allocator.
+		auto& src_edges =
+		   edges_rep_.try_emplace(src, edges_set_t(edges_rep_.get_allocator())).first->second;
+		if (!src_edges
+		        .emplace(std::piecewise_construct,
+		                 std::forward_as_tuple(dst),
+		                 std::forward_as_tuple(std::forward<Args>(args)...))
+		        .second)
+		{
+			return false;
+		}
+		in_edges_rep_.try_emplace(dst, sources_set_t(in_edges_rep_.get_allocator()))
+		   .first->second.emplace(src);
+		src->out_degree++;
+		dst->in_degree++;
+		num_edges_++;
+		return true;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::is_connected_ptr(node_entry const* src,
+	                                                       node_entry const* dst) const -> bool {
+		auto src_search = edges_rep_.find(src);
+		if (src_search == edges_rep_.end()) {
+			return false;
+		}
+		return src_search->second.contains(dst);
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::weights_ptr(node_entry const* src,
+	                                                  node_entry const* dst) const
+	   -> std::vector<E> {
+		auto result_vec = std::vector<E>{};
+
+		auto src_search = edges_rep_.find(src);
 		if (src_search == edges_rep_.end()) {
+			return result_vec;
+		}
+		auto const [first, last] = src_search->second.equal_range(dst);
+		for (auto iter = first; iter != last; iter++) {
+			result_vec.emplace_back(iter->second);
+		}
+		return result_vec;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::find_ptr(node_entry const* src,
+	                                               node_entry const* dst,
+	                                               E const& weight) const -> iterator {
+		// Either entry may be null, for a node that does not exist.
+		if (src == nullptr || dst == nullptr) {
 			return iterator(edges_rep_, true);
 		}
-		auto dst_search = nodes_rep_.find(&dst);
-		if (dst_search == nodes_rep_.end()) {
+		auto src_search = edges_rep_.find(src);
+
+		if (src_search == edges_rep_.end()) {
 			return iterator(edges_rep_, true);
 		}
-		auto dst_ptr = *dst_search;
 		auto const& src_edges = src_search->second;
 
-		auto edge_search = src_edges.find(std::pair<N const*, E>(dst_ptr, weight));
+		auto edge_search = src_edges.find(std::pair<node_entry const*, E>(dst, weight));
 
 		if (edge_search == src_edges.end()) {
 			return iterator(edges_rep_, true);
@@ -628,30 +2521,276 @@ namespace gdwg {
 		return iterator(edges_rep_, src_search, edge_search);
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::erase_edge(iterator i) -> iterator {
-		auto iter = i;
-		auto const map_iter = iter.curr_map_iter_;
-		auto non_c_iter = edges_rep_.erase(map_iter, map_iter);
-		auto const set_iter = iter.curr_set_iter_;
-		iter++;
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::update_weight_ptr(node_entry const* src,
+	                                                        node_entry const* dst,
+	                                                        E const& old_weight,
+	                                                        E const& new_weight) -> bool {
+		auto const iter = find_ptr(src, dst, old_weight);
+		if (iter == end()) {
+			return false;
+		}
+		if (!(old_weight < new_weight) && !(new_weight < old_weight)) {
+			return true;
+		}
+		auto const map_iter = edges_rep_.erase(iter.curr_map_iter_, iter.curr_map_iter_);
+		auto& src_edges = map_iter->second;
+		if (src_edges.contains(std::pair<node_entry const*, E>(dst, new_weight))) {
+			return false;
+		}
+		// The edge keeps its node and is only relinked at its new position, so nothing is freed
+		// or allocated and the counts and the in-edge index stay as they are.
+		auto node = src_edges.extract(iter.curr_set_iter_);
+		node.value().second = new_weight;
+		src_edges.insert(std::move(node));
+		return true;
+	}
 
-		non_c_iter->second.erase(set_iter);
-		if ((non_c_iter->second).empty()) {
-			edges_rep_.erase(map_iter);
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::edges_of(node_entry const* src) const
+	   -> std::ranges::subrange<edges_set_iter_t> {
+		auto const src_search = edges_rep_.find(src);
+		if (src_search == edges_rep_.end()) {
+			return {};
 		}
-		return iter;
+		return std::ranges::subrange(src_search->second.begin(), src_search->second.end());
 	}
 
-	template<typename N, typename E>
-	auto graph<N, E>::erase_edge(iterator i, iterator s) -> iterator {
-		auto iter = i;
-		while (iter != s) {
-			iter = erase_edge(iter);
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename F, typename... Args>
+	auto graph<N, E, Allocator, Storage>::visit(F& f, Args const&... args) -> bool {
+		if constexpr (std::is_void_v<std::invoke_result_t<F&, Args const&...>>) {
+			std::invoke(f, args...);
+			return true;
+		}
+		else {
+			return static_cast<bool>(std::invoke(f, args...));
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::partition_sources(unsigned num_runs) const
+	   -> std::vector<edges_map_iter_t> {
+		auto const runs = std::size_t{std::max(num_runs, 1U)};
+		auto bounds = std::vector<edges_map_iter_t>{edges_rep_.begin()};
+		auto seen = std::size_t{0};
+		for (auto iter = edges_rep_.begin(); iter != edges_rep_.end();) {
+			seen += iter->second.size();
+			iter++;
+			// Run k ends at the first source boundary at least k / runs of the way through.
+			if (iter != edges_rep_.end() && seen * runs >= bounds.size() * num_edges_) {
+				bounds.push_back(iter);
+			}
+		}
+		bounds.push_back(edges_rep_.end());
+		return bounds;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename Work>
+	auto graph<N, E, Allocator, Storage>::run_in_parallel(std::size_t num_tasks, Work& work)
+	   -> void {
+		auto errors = std::vector<std::exception_ptr>(num_tasks);
+		auto run = [&](std::size_t task) {
+			try {
+				work(task);
+			} catch (...) {
+				errors[task] = std::current_exception();
+			}
+		};
+		{
+			auto threads = std::vector<std::jthread>{};
+			threads.reserve(num_tasks);
+			for (auto task = std::size_t{1}; task < num_tasks; task++) {
+				threads.emplace_back(run, task);
+			}
+			run(0);
+		}
+		for (auto const& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::unlink_source(node_entry const* src, node_entry const* dst)
+	   -> void {
+		auto const dst_search = in_edges_rep_.find(dst);
+		dst_search->second.erase(src);
+		if (dst_search->second.empty()) {
+			in_edges_rep_.erase(dst_search);
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_incident_edges(node_entry const* node) -> void {
+		auto const in_search = in_edges_rep_.find(node);
+		if (in_search != in_edges_rep_.end()) {
+			for (auto const src : in_search->second) {
+				if (src == node) {
+					continue;
+				}
+				auto const src_search = edges_rep_.find(src);
+				auto& src_edges = src_search->second;
+				auto const [first, last] = src_edges.equal_range(node);
+				auto const count = static_cast<std::size_t>(std::distance(first, last));
+				src_edges.erase(first, last);
+				src->out_degree -= count;
+				num_edges_ -= count;
+				if (src_edges.empty()) {
+					edges_rep_.erase(src_search);
+				}
+			}
+			in_edges_rep_.erase(in_search);
+		}
+
+		auto const out_search = edges_rep_.find(node);
+		if (out_search != edges_rep_.end()) {
+			auto const& out_edges = out_search->second;
+			for (auto const& [dst, weight] : out_edges) {
+				dst->in_degree--;
+			}
+			for (auto iter = out_edges.begin(); iter != out_edges.end();
+			     iter = out_edges.upper_bound(iter->first)) {
+				if (iter->first != node) {
+					unlink_source(node, iter->first);
+				}
+			}
+			num_edges_ -= out_edges.size();
+			edges_rep_.erase(out_search);
+		}
+		node->out_degree = 0;
+		node->in_degree = 0;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::collect_edges(std::vector<node_entry const*> const& nodes,
+	                                                    std::vector<pending_edge>& pending) const
+	   -> void {
+		auto degree = std::size_t{0};
+		for (auto const node : nodes) {
+			degree += node->out_degree + node->in_degree;
+		}
+		pending.reserve(pending.size() + degree);
+		// An edge between two listed nodes is taken from its source only.
+		for (auto const node : nodes) {
+			for (auto const& [dst, weight] : edges_of(node)) {
+				pending.push_back({node, dst, weight});
+			}
+			auto const in_search = in_edges_rep_.find(node);
+			if (in_search == in_edges_rep_.end()) {
+				continue;
+			}
+			for (auto const src : in_search->second) {
+				if (std::binary_search(nodes.begin(), nodes.end(), src, std::less<>())) {
+					continue;
+				}
+				auto const [first, last] = edges_rep_.find(src)->second.equal_range(node);
+				for (auto iter = first; iter != last; iter++) {
+					pending.push_back({src, node, iter->second});
+				}
+			}
+		}
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	template<typename Pred>
+	auto graph<N, E, Allocator, Storage>::erase_edges_where(Pred pred) -> std::size_t {
+		// Everything is kept consistent edge by edge, in case pred throws.
+		auto erased = std::size_t{0};
+		for (auto map_iter = edges_rep_.begin(); map_iter != edges_rep_.end();) {
+			auto const src = map_iter->first;
+			auto& src_edges = map_iter->second;
+			for (auto iter = src_edges.begin(); iter != src_edges.end();) {
+				auto const dst = iter->first;
+				if (!pred(src, dst, iter->second)) {
+					iter++;
+					continue;
+				}
+				iter = src_edges.erase(iter);
+				src->out_degree--;
+				dst->in_degree--;
+				num_edges_--;
+				erased++;
+				// Edges to dst sit together, so one of them would have to be next to iter.
+				auto const dst_remains =
+				   (iter != src_edges.end() && iter->first == dst)
+				   || (iter != src_edges.begin() && std::prev(iter)->first == dst);
+				if (!dst_remains) {
+					unlink_source(src, dst);
+				}
+			}
+			map_iter = src_edges.empty() ? edges_rep_.erase(map_iter) : std::next(map_iter);
+		}
+		return erased;
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_edges_of(std::vector<node_entry const*> const& nodes)
+	   -> void {
+		auto degree = std::size_t{0};
+		for (auto const node : nodes) {
+			degree += node->out_degree + node->in_degree;
+		}
+		if (degree <= num_edges_ / 4) {
+			for (auto const node : nodes) {
+				erase_incident_edges(node);
+			}
+			return;
+		}
+
+		auto listed = std::vector<bool>(id_bound_);
+		for (auto const node : nodes) {
+			listed[node->id] = true;
+		}
+		erase_edges_where([&](node_entry const* src, node_entry const* dst, E const&) -> bool {
+			return listed[src->id] || listed[dst->id];
+		});
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_doomed_nodes(
+	   std::vector<node_entry const*> const& doomed) -> void {
+		if (doomed.empty()) {
+			return;
+		}
+		// Reserved first so that nothing below can throw once edges start to go.
+		free_ids_.reserve(free_ids_.size() + doomed.size());
+		erase_edges_of(doomed);
+		for (auto const node : doomed) {
+			erase_node_ptr(node);
 		}
-		return iter;
 	}
 
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::iterator_at(typename edges_map_t::iterator map_iter,
+	                                                  edges_set_iter_t set_iter) -> iterator {
+		if (set_iter != map_iter->second.end()) {
+			return iterator(edges_rep_, map_iter, set_iter);
+		}
+		auto const next_map_iter =
+		   map_iter->second.empty() ? edges_rep_.erase(map_iter) : std::next(map_iter);
+		if (next_map_iter == edges_rep_.end()) {
+			return end();
+		}
+		return iterator(edges_rep_, next_map_iter, next_map_iter->second.begin());
+	}
+
+	template<typename N, typename E, typename Allocator, typename Storage>
+	auto graph<N, E, Allocator, Storage>::erase_node_ptr(node_entry const* node) -> void {
+		free_ids_.emplace_back(node->id);
+		nodes_rep_.erase(nodes_rep_.find(node->value));
+	}
+
+	template<typename N, typename E, std::size_t Threshold = 16>
+	using flat_graph = graph<N, E, std::allocator<std::byte>, flat_storage<Threshold>>;
+
+	namespace pmr {
+		template<typename N, typename E, typename Storage = tree_storage>
+		using graph = gdwg::graph<N, E, std::pmr::polymorphic_allocator<std::byte>, Storage>;
+	} // namespace pmr
+
 } // namespace gdwg
 
 #endif
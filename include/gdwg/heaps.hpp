@@ -0,0 +1,354 @@
+#ifndef GDWG_HEAPS_HPP
+#define GDWG_HEAPS_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	namespace detail {
+		// The queues below all hold ids in [0, num_ids) keyed by Key, and share one interface:
+		// push(id, key) for an id not in the queue, decrease(id, key) for one that is, with a key
+		// no greater than its current one, and pop(), which removes and returns an id with the
+		// least key. An id can be pushed again once it has been popped.
+		using queue_id = std::uint32_t;
+
+		// Implicit heap in which every element has Arity children. It records where each id sits,
+		// so decrease() moves the element up from there instead of adding a second copy of it.
+		template<typename Key, std::size_t Arity>
+		class dary_queue {
+		public:
+			static_assert(Arity >= 2);
+
+			explicit dary_queue(std::size_t num_ids)
+			: positions_(num_ids) {}
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return heap_.empty();
+			}
+
+			auto push(queue_id id, Key key) -> void {
+				heap_.push_back({key, id});
+				sift_up(heap_.size() - 1);
+			}
+			auto decrease(queue_id id, Key key) -> void {
+				heap_[positions_[id]].key = key;
+				sift_up(positions_[id]);
+			}
+			auto pop() -> queue_id {
+				auto const top = heap_.front().id;
+				auto const last = heap_.back();
+				heap_.pop_back();
+				if (!heap_.empty()) {
+					heap_.front() = last;
+					sift_down(0);
+				}
+				return top;
+			}
+
+		private:
+			// Keys sit next to their ids so that comparing children does not chase an index.
+			struct element {
+				Key key;
+				queue_id id;
+			};
+			std::vector<element> heap_;
+			std::vector<std::size_t> positions_;
+
+			auto place(std::size_t pos, element const& e) -> void {
+				heap_[pos] = e;
+				positions_[e.id] = pos;
+			}
+			auto sift_up(std::size_t pos) -> void {
+				auto const e = heap_[pos];
+				while (pos > 0) {
+					auto const parent = (pos - 1) / Arity;
+					if (!(e.key < heap_[parent].key)) {
+						break;
+					}
+					place(pos, heap_[parent]);
+					pos = parent;
+				}
+				place(pos, e);
+			}
+			auto sift_down(std::size_t pos) -> void {
+				auto const e = heap_[pos];
+				auto const size = heap_.size();
+				while (true) {
+					auto const first = pos * Arity + 1;
+					if (first >= size) {
+						break;
+					}
+					auto best = first;
+					auto const last = std::min(first + Arity, size);
+					for (auto child = first + 1; child < last; child++) {
+						if (heap_[child].key < heap_[best].key) {
+							best = child;
+						}
+					}
+					if (!(heap_[best].key < e.key)) {
+						break;
+					}
+					place(pos, heap_[best]);
+					pos = best;
+				}
+				place(pos, e);
+			}
+		};
+
+		// The unsigned integer that a non-negative Key is bucketed by. Non-negative IEEE floats
+		// order the same way as their bit patterns, so float and double keys can be used too.
+		template<typename Key>
+		struct radix_bits {};
+		template<std::integral Key>
+		struct radix_bits<Key> {
+			using type = std::make_unsigned_t<Key>;
+		};
+		template<>
+		struct radix_bits<float> {
+			using type = std::uint32_t;
+		};
+		template<>
+		struct radix_bits<double> {
+			using type = std::uint64_t;
+		};
+
+		template<typename Key>
+		concept radix_key = requires { typename radix_bits<Key>::type; }
+		                    && sizeof(Key) == sizeof(typename radix_bits<Key>::type);
+
+		// Monotone radix heap: a key pushed has to be no less than the last key popped, which holds
+		// for Dijkstra's algorithm with non-negative weights, and then every key lives in the
+		// bucket of the highest bit in which it differs from that last key. Keys have to be
+		// non-negative. decrease() leaves the old element in place, and pop() drops it later.
+		template<radix_key Key>
+		class radix_queue {
+		public:
+			explicit radix_queue(std::size_t num_ids)
+			: keys_(num_ids) {}
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return size_ == 0;
+			}
+
+			auto push(queue_id id, Key key) -> void {
+				keys_[id] = to_bits(key);
+				insert({keys_[id], id});
+				size_++;
+			}
+			auto decrease(queue_id id, Key key) -> void {
+				keys_[id] = to_bits(key);
+				insert({keys_[id], id});
+			}
+			auto pop() -> queue_id {
+				while (true) {
+					if (buckets_[0].empty()) {
+						refill();
+					}
+					auto const e = buckets_[0].back();
+					buckets_[0].pop_back();
+					// Keys only ever decrease, so an element whose key is not its id's current
+					// one was left behind by decrease().
+					if (is_current(e)) {
+						size_--;
+						return e.id;
+					}
+				}
+			}
+
+		private:
+			using bits_type = typename radix_bits<Key>::type;
+			struct element {
+				bits_type bits;
+				queue_id id;
+			};
+
+			std::array<std::vector<element>, std::numeric_limits<bits_type>::digits + 1> buckets_;
+			std::vector<bits_type> keys_;
+			bits_type last_ = 0;
+			std::size_t size_ = 0;
+
+			static auto to_bits(Key key) noexcept -> bits_type {
+				if constexpr (std::integral<Key>) {
+					return static_cast<bits_type>(key);
+				}
+				else {
+					return std::bit_cast<bits_type>(key);
+				}
+			}
+			auto is_current(element const& e) const noexcept -> bool {
+				return e.bits == keys_[e.id];
+			}
+			auto insert(element const& e) -> void {
+				auto const bucket = std::bit_width(static_cast<bits_type>(e.bits ^ last_));
+				buckets_[static_cast<std::size_t>(bucket)].push_back(e);
+			}
+			// Moves the least key of the first non-empty bucket into last_, which spreads the rest
+			// of that bucket over lower buckets.
+			auto refill() -> void {
+				auto i = std::size_t{1};
+				while (buckets_[0].empty()) {
+					while (buckets_[i].empty()) {
+						i++;
+					}
+					auto bucket = std::vector<element>();
+					bucket.swap(buckets_[i]);
+					auto least = std::numeric_limits<bits_type>::max();
+					auto any_current = false;
+					for (auto const& e : bucket) {
+						if (is_current(e)) {
+							least = std::min(least, e.bits);
+							any_current = true;
+						}
+					}
+					if (any_current) {
+						last_ = least;
+						for (auto const& e : bucket) {
+							if (is_current(e)) {
+								insert(e);
+							}
+						}
+					}
+					// The bucket keeps its capacity, as it will be refilled sooner or later.
+					bucket.clear();
+					buckets_[i].swap(bucket);
+				}
+			}
+		};
+
+		// Pairing heap whose nodes are preallocated, one per id. Each node links to its first
+		// child, its next sibling, and the node before it: its left sibling, or its parent if it is
+		// a first child. decrease() cuts the node's subtree out and melds it with the root.
+		template<typename Key>
+		class pairing_queue {
+		public:
+			explicit pairing_queue(std::size_t num_ids)
+			: nodes_(num_ids) {}
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return root_ == none;
+			}
+
+			auto push(queue_id id, Key key) -> void {
+				nodes_[id] = node{key, none, none, none};
+				root_ = root_ == none ? id : meld(root_, id);
+			}
+			auto decrease(queue_id id, Key key) -> void {
+				nodes_[id].key = key;
+				if (id == root_) {
+					return;
+				}
+				auto& n = nodes_[id];
+				auto& before = nodes_[n.prev];
+				if (before.child == id) {
+					before.child = n.sibling;
+				}
+				else {
+					before.sibling = n.sibling;
+				}
+				if (n.sibling != none) {
+					nodes_[n.sibling].prev = n.prev;
+				}
+				n.sibling = none;
+				n.prev = none;
+				root_ = meld(root_, id);
+			}
+			auto pop() -> queue_id {
+				auto const top = root_;
+				root_ = merge_pairs(nodes_[top].child);
+				if (root_ != none) {
+					nodes_[root_].prev = none;
+				}
+				return top;
+			}
+
+		private:
+			static constexpr auto none = std::numeric_limits<queue_id>::max();
+			struct node {
+				Key key;
+				queue_id child;
+				queue_id sibling;
+				queue_id prev;
+			};
+			std::vector<node> nodes_;
+			std::vector<queue_id> pairs_;
+			queue_id root_ = none;
+
+			// Makes the root with the greater key the first child of the other. Both have to be
+			// roots without siblings.
+			auto meld(queue_id a, queue_id b) -> queue_id {
+				if (nodes_[b].key < nodes_[a].key) {
+					std::swap(a, b);
+				}
+				auto& parent = nodes_[a];
+				auto& child = nodes_[b];
+				child.sibling = parent.child;
+				if (parent.child != none) {
+					nodes_[parent.child].prev = b;
+				}
+				child.prev = a;
+				parent.child = b;
+				return a;
+			}
+			// The standard two passes: meld the siblings from first in pairs, then meld the pairs
+			// from last into one tree.
+			auto merge_pairs(queue_id first) -> queue_id {
+				pairs_.clear();
+				while (first != none) {
+					auto const a = first;
+					auto const b = nodes_[a].sibling;
+					if (b == none) {
+						detach(a);
+						pairs_.push_back(a);
+						break;
+					}
+					first = nodes_[b].sibling;
+					detach(a);
+					detach(b);
+					pairs_.push_back(meld(a, b));
+				}
+				auto root = none;
+				for (auto i = pairs_.size(); i > 0; i--) {
+					root = root == none ? pairs_[i - 1] : meld(pairs_[i - 1], root);
+				}
+				return root;
+			}
+			auto detach(queue_id id) -> void {
+				nodes_[id].sibling = none;
+				nodes_[id].prev = none;
+			}
+		};
+	} // namespace detail
+
+	// Heap policies for gdwg::shortest_paths, each naming the queue it uses for keys of type Key.
+	// binary_heap and dary_heap are implicit heaps with decrease-key.
+	template<std::size_t Arity = 4>
+	struct dary_heap {
+		template<typename Key>
+		using queue_type = detail::dary_queue<Key, Arity>;
+	};
+	using binary_heap = dary_heap<2>;
+
+	// radix_heap buckets keys by their highest bit that differs from the last key popped, which
+	// makes pushing O(1). It needs integral, float or double weights.
+	struct radix_heap {
+		template<typename Key>
+		using queue_type = detail::radix_queue<Key>;
+	};
+
+	// pairing_heap has O(1) push and decrease-key, at the cost of pointer chasing on pop.
+	struct pairing_heap {
+		template<typename Key>
+		using queue_type = detail::pairing_queue<Key>;
+	};
+
+} // namespace gdwg
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef GDWG_LOOKUP_KEY_HPP
+#define GDWG_LOOKUP_KEY_HPP
+
+#include <concepts>
+
+namespace gdwg::detail {
+	// A type that node lookups accept in place of N, such as a string literal or std::string_view
+	// for std::string nodes, so that looking a node up does not have to construct an N. It has to
+	// order the same way as the N it stands for.
+	template<typename K, typename N>
+	concept lookup_key = requires(K const& key, N const& value) {
+		{ key < value } -> std::convertible_to<bool>;
+		{ value < key } -> std::convertible_to<bool>;
+	};
+} // namespace gdwg::detail
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef GDWG_MEMORY_FOOTPRINT_HPP
+#define GDWG_MEMORY_FOOTPRINT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace gdwg {
+	// How many bytes a value owns on the heap on top of its own sizeof, which
+	// graph::memory_usage() adds up over every node value and weight. Strings and vectors are
+	// measured by capacity, and anything else counts as owning nothing unless heap_size is
+	// specialised for it.
+	template<typename T>
+	struct heap_size {
+		auto operator()(T const&) const noexcept -> std::size_t {
+			return 0;
+		}
+	};
+
+	template<typename CharT, typename Traits, typename Alloc>
+	struct heap_size<std::basic_string<CharT, Traits, Alloc>> {
+		auto operator()(std::basic_string<CharT, Traits, Alloc> const& value) const noexcept
+		   -> std::size_t {
+			// A string short enough to fit in the object itself has the capacity of an empty one.
+			static auto const inline_capacity = std::basic_string<CharT, Traits, Alloc>().capacity();
+			return value.capacity() > inline_capacity ? (value.capacity() + 1) * sizeof(CharT) : 0;
+		}
+	};
+
+	template<typename T, typename Alloc>
+	struct heap_size<std::vector<T, Alloc>> {
+		auto operator()(std::vector<T, Alloc> const& value) const noexcept -> std::size_t {
+			auto bytes = value.capacity() * sizeof(T);
+			for (auto const& element : value) {
+				bytes += heap_size<T>()(element);
+			}
+			return bytes;
+		}
+	};
+
+	// The bytes a graph holds on the heap, by what they are used for. The graph object itself is
+	// not included.
+	struct memory_footprint {
+		// What node values and weights own themselves, as measured by heap_size.
+		std::size_t node_values = 0;
+		std::size_t edge_weights = 0;
+		// The entry every node is interned in, which edges point at.
+		std::size_t node_entries = 0;
+		// The tree that owns the entries and orders them by value.
+		std::size_t node_set = 0;
+		// One map node per node with out-edges, and the sets that hold those edges.
+		std::size_t edge_maps = 0;
+		std::size_t edge_sets = 0;
+		// The map and sets recording which nodes have edges to each node.
+		std::size_t in_edge_index = 0;
+		// Ids of erased nodes waiting to be reused.
+		std::size_t free_ids = 0;
+
+		auto total() const noexcept -> std::size_t {
+			return node_values + edge_weights + node_entries + node_set + edge_maps + edge_sets
+			       + in_edge_index + free_ids;
+		}
+		auto operator==(memory_footprint const& other) const -> bool = default;
+	};
+
+	namespace detail {
+		// The size of one node of a std::set or std::map holding T. libstdc++, libc++ and the
+		// Microsoft library all put three links and a colour, padded to a pointer, before it.
+		template<typename T>
+		constexpr auto tree_node_size() noexcept -> std::size_t {
+			constexpr auto node_align = std::max(alignof(void*), alignof(T));
+			constexpr auto element_offset = (4 * sizeof(void*) + alignof(T) - 1) / alignof(T)
+			                                * alignof(T);
+			return (element_offset + sizeof(T) + node_align - 1) / node_align * node_align;
+		}
+
+		template<typename T, typename Compare, typename Alloc>
+		auto container_bytes(std::set<T, Compare, Alloc> const& set) noexcept -> std::size_t {
+			return set.size() * tree_node_size<T>();
+		}
+		template<typename K, typename V, typename Compare, typename Alloc>
+		auto container_bytes(std::map<K, V, Compare, Alloc> const& map) noexcept -> std::size_t {
+			return map.size() * tree_node_size<std::pair<K const, V>>();
+		}
+	} // namespace detail
+} // namespace gdwg
+
+#endif
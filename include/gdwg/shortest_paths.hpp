@@ -0,0 +1,350 @@
+#ifndef GDWG_SHORTEST_PATHS_HPP
+#define GDWG_SHORTEST_PATHS_HPP
+
+#include "gdwg/csr_graph.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/heaps.hpp"
+#include "gdwg/lookup_key.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	namespace detail {
+		// Weights that shortest_paths can add up and compare.
+		template<typename E>
+		concept path_weight = std::is_arithmetic_v<E> && !std::same_as<E, bool>;
+
+		template<typename Heap, typename G>
+		struct dijkstra;
+	} // namespace detail
+
+	// What gdwg::shortest_paths found: each node it settled, with its distance from the source
+	// and the node before it on one shortest path. That is every node reachable from the source,
+	// unless a target stopped the search as soon as it was settled.
+	template<typename N, typename E>
+	class shortest_path_tree {
+	public:
+		shortest_path_tree() = default;
+
+		// Node parameters accept any detail::lookup_key<N>. A node that was not settled, or that
+		// is not in the graph at all, is not reached and has no distance or path.
+		template<detail::lookup_key<N> K = N>
+		auto reached(K const& node) const -> bool;
+		template<detail::lookup_key<N> K = N>
+		auto distance(K const& node) const -> std::optional<E>;
+		// The nodes of a shortest path, from the source to dst inclusive.
+		template<detail::lookup_key<N> K = N>
+		auto path(K const& dst) const -> std::vector<N>;
+		// The reached nodes, in ascending order.
+		auto nodes() const -> std::vector<N>;
+		auto operator==(shortest_path_tree<N, E> const& other) const -> bool = default;
+
+	private:
+		template<typename Heap, typename G>
+		friend struct detail::dijkstra;
+
+		// Reached node i is nodes_[i], and parents_[i] is the index of the node before it, which
+		// is i itself for the source.
+		std::vector<N> nodes_;
+		std::vector<E> distances_;
+		std::vector<std::size_t> parents_;
+
+		template<typename K>
+		auto index_of(K const& value) const -> std::size_t;
+	};
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto shortest_path_tree<N, E>::reached(K const& node) const -> bool {
+		return index_of(node) != nodes_.size();
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto shortest_path_tree<N, E>::distance(K const& node) const -> std::optional<E> {
+		auto const index = index_of(node);
+		if (index == nodes_.size()) {
+			return std::nullopt;
+		}
+		return distances_[index];
+	}
+
+	template<typename N, typename E>
+	template<detail::lookup_key<N> K>
+	[[nodiscard]] auto shortest_path_tree<N, E>::path(K const& dst) const -> std::vector<N> {
+		auto index = index_of(dst);
+		if (index == nodes_.size()) {
+			return {};
+		}
+		auto result_vec = std::vector<N>{nodes_[index]};
+		while (parents_[index] != index) {
+			index = parents_[index];
+			result_vec.push_back(nodes_[index]);
+		}
+		std::reverse(result_vec.begin(), result_vec.end());
+		return result_vec;
+	}
+
+	template<typename N, typename E>
+	[[nodiscard]] auto shortest_path_tree<N, E>::nodes() const -> std::vector<N> {
+		return nodes_;
+	}
+
+	template<typename N, typename E>
+	template<typename K>
+	auto shortest_path_tree<N, E>::index_of(K const& value) const -> std::size_t {
+		auto const search = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+		if (search == nodes_.end() || value < *search) {
+			return nodes_.size();
+		}
+		return static_cast<std::size_t>(search - nodes_.begin());
+	}
+
+	namespace detail {
+		// Walks a gdwg::graph through its entries, whose dense ids index the search's arrays.
+		template<typename N, typename E, typename Allocator, typename Storage>
+		struct adjacency_access<graph<N, E, Allocator, Storage>> {
+			using graph_type = graph<N, E, Allocator, Storage>;
+			using vertex = typename graph_type::node_entry const*;
+			using node_type = N;
+			using weight_type = E;
+
+			static auto num_ids(graph_type const& g) noexcept -> std::size_t {
+				return g.id_bound_;
+			}
+			template<typename K>
+			static auto find(graph_type const& g, K const& value) -> std::optional<vertex> {
+				auto const entry = g.find_entry(value);
+				return entry == nullptr ? std::nullopt : std::optional<vertex>(entry);
+			}
+			static auto id(graph_type const&, vertex v) noexcept -> std::size_t {
+				return v->id;
+			}
+			static auto value(graph_type const&, vertex v) noexcept -> N const& {
+				return v->value;
+			}
+			static auto precedes(graph_type const&, vertex v1, vertex v2) noexcept -> bool {
+				return v1->rank < v2->rank;
+			}
+			// Calls f(dst, weight) for each of v's out-edges.
+			template<typename F>
+			static auto for_each_out_edge(graph_type const& g, vertex v, F& f) -> void {
+				if (v->out_degree == 0) {
+					return;
+				}
+				for (auto const& [dst, weight] : g.edges_of(v)) {
+					f(dst, weight);
+				}
+			}
+		};
+
+		// Walks a gdwg::csr_graph by node index.
+		template<typename N, typename E>
+		struct adjacency_access<csr_graph<N, E>> {
+			using graph_type = csr_graph<N, E>;
+			using vertex = std::size_t;
+			using node_type = N;
+			using weight_type = E;
+
+			static auto num_ids(graph_type const& g) noexcept -> std::size_t {
+				return g.nodes_.size();
+			}
+			template<typename K>
+			static auto find(graph_type const& g, K const& value) -> std::optional<vertex> {
+				auto const index = g.index_of(value);
+				return index == g.nodes_.size() ? std::nullopt : std::optional<vertex>(index);
+			}
+			static auto id(graph_type const&, vertex v) noexcept -> std::size_t {
+				return v;
+			}
+			static auto value(graph_type const& g, vertex v) noexcept -> N const& {
+				return g.nodes_[v];
+			}
+			static auto precedes(graph_type const&, vertex v1, vertex v2) noexcept -> bool {
+				return v1 < v2;
+			}
+			template<typename F>
+			static auto for_each_out_edge(graph_type const& g, vertex v, F& f) -> void {
+				for (auto e = g.offsets_[v]; e < g.offsets_[v + 1]; e++) {
+					f(vertex{g.dsts_[e]}, g.weights_[e]);
+				}
+			}
+		};
+
+		// Dijkstra's algorithm over any graph type with an adjacency_access, with Heap's queue
+		// ordering the nodes that have been reached but not yet settled.
+		template<typename Heap, typename G>
+		struct dijkstra {
+			using access = adjacency_access<G>;
+			using vertex = typename access::vertex;
+			using N = typename access::node_type;
+			using E = typename access::weight_type;
+
+			static auto run(G const& g, vertex source, std::optional<vertex> target)
+			   -> shortest_path_tree<N, E> {
+				auto const num_ids = access::num_ids(g);
+				auto distances = std::vector<E>(num_ids);
+				auto parents = std::vector<vertex>(num_ids);
+				auto vertices = std::vector<vertex>(num_ids);
+				auto states = std::vector<state>(num_ids, state::unseen);
+				auto settled = std::vector<vertex>();
+				auto queue = typename Heap::template queue_type<E>(num_ids);
+
+				auto const source_id = access::id(g, source);
+				distances[source_id] = E{};
+				parents[source_id] = source;
+				vertices[source_id] = source;
+				states[source_id] = state::queued;
+				queue.push(static_cast<queue_id>(source_id), E{});
+
+				while (!queue.empty()) {
+					auto const id = queue.pop();
+					auto const v = vertices[id];
+					states[id] = state::settled;
+					settled.push_back(v);
+					if (v == target) {
+						break;
+					}
+
+					auto const base = distances[id];
+					auto relax = [&](vertex dst, E const& weight) {
+						if constexpr (std::is_signed_v<E>) {
+							if (weight < E{}) {
+								throw std::runtime_error("Cannot call gdwg::shortest_paths on a graph "
+								                         "with a negative weight");
+							}
+						}
+						auto const dst_id = access::id(g, dst);
+						auto const candidate = static_cast<E>(base + weight);
+						if (states[dst_id] == state::unseen) {
+							distances[dst_id] = candidate;
+							parents[dst_id] = v;
+							vertices[dst_id] = dst;
+							states[dst_id] = state::queued;
+							queue.push(static_cast<queue_id>(dst_id), candidate);
+						}
+						else if (states[dst_id] == state::queued && candidate < distances[dst_id]) {
+							distances[dst_id] = candidate;
+							parents[dst_id] = v;
+							queue.decrease(static_cast<queue_id>(dst_id), candidate);
+						}
+					};
+					access::for_each_out_edge(g, v, relax);
+				}
+
+				return make_tree(g, settled, distances, parents);
+			}
+
+		private:
+			enum class state : std::uint8_t { unseen, queued, settled };
+
+			// Copies the settled nodes out in value order, with parents turned into indices.
+			static auto make_tree(G const& g,
+			                      std::vector<vertex>& settled,
+			                      std::vector<E> const& distances,
+			                      std::vector<vertex> const& parents) -> shortest_path_tree<N, E> {
+				std::sort(settled.begin(), settled.end(), [&](vertex v1, vertex v2) {
+					return access::precedes(g, v1, v2);
+				});
+				auto indices = std::vector<std::size_t>(access::num_ids(g));
+				for (auto i = std::size_t{0}; i < settled.size(); i++) {
+					indices[access::id(g, settled[i])] = i;
+				}
+
+				auto tree = shortest_path_tree<N, E>();
+				tree.nodes_.reserve(settled.size());
+				tree.distances_.reserve(settled.size());
+				tree.parents_.reserve(settled.size());
+				for (auto const v : settled) {
+					auto const id = access::id(g, v);
+					tree.nodes_.push_back(access::value(g, v));
+					tree.distances_.push_back(distances[id]);
+					// A node's parent was settled before it relaxed the edge to it.
+					tree.parents_.push_back(indices[access::id(g, parents[id])]);
+				}
+				return tree;
+			}
+		};
+
+		template<typename Heap, typename G, typename K>
+		auto shortest_paths_from(G const& g, K const& src) -> auto {
+			auto const source = adjacency_access<G>::find(g, src);
+			if (!source) {
+				throw std::runtime_error("Cannot call gdwg::shortest_paths if src doesn't exist in "
+				                         "the graph");
+			}
+			return dijkstra<Heap, G>::run(g, *source, std::nullopt);
+		}
+
+		template<typename Heap, typename G, typename K, typename T>
+		auto shortest_paths_to(G const& g, K const& src, T const& target) -> auto {
+			auto const source = adjacency_access<G>::find(g, src);
+			auto const stop = adjacency_access<G>::find(g, target);
+			if (!source || !stop) {
+				throw std::runtime_error("Cannot call gdwg::shortest_paths if src or target don't "
+				                         "exist in the graph");
+			}
+			return dijkstra<Heap, G>::run(g, *source, stop);
+		}
+	} // namespace detail
+
+	// Single-source shortest paths by Dijkstra's algorithm, run directly over the graph's own
+	// containers, or over a frozen csr_graph, which walks each node's edges contiguously. Every
+	// weight has to be non-negative; distances are sums in E, so they can overflow as any other
+	// sum of E would. Heap picks the priority queue, from heaps.hpp; a 4-ary heap is the default,
+	// as it settles nodes faster than a binary heap on sparse graphs.
+	//
+	// Given a target, the search stops as soon as the target is settled, and the tree holds only
+	// the nodes settled by then, whose distances are final.
+	template<typename Heap = dary_heap<>,
+	         typename N,
+	         detail::path_weight E,
+	         typename Allocator,
+	         typename Storage,
+	         detail::lookup_key<N> K = N>
+	auto shortest_paths(graph<N, E, Allocator, Storage> const& g, K const& src)
+	   -> shortest_path_tree<N, E> {
+		return detail::shortest_paths_from<Heap>(g, src);
+	}
+
+	template<typename Heap = dary_heap<>,
+	         typename N,
+	         detail::path_weight E,
+	         typename Allocator,
+	         typename Storage,
+	         detail::lookup_key<N> K = N,
+	         detail::lookup_key<N> T = N>
+	auto shortest_paths(graph<N, E, Allocator, Storage> const& g, K const& src, T const& target)
+	   -> shortest_path_tree<N, E> {
+		return detail::shortest_paths_to<Heap>(g, src, target);
+	}
+
+	template<typename Heap = dary_heap<>,
+	         typename N,
+	         detail::path_weight E,
+	         detail::lookup_key<N> K = N>
+	auto shortest_paths(csr_graph<N, E> const& g, K const& src) -> shortest_path_tree<N, E> {
+		return detail::shortest_paths_from<Heap>(g, src);
+	}
+
+	template<typename Heap = dary_heap<>,
+	         typename N,
+	         detail::path_weight E,
+	         detail::lookup_key<N> K = N,
+	         detail::lookup_key<N> T = N>
+	auto shortest_paths(csr_graph<N, E> const& g, K const& src, T const& target)
+	   -> shortest_path_tree<N, E> {
+		return detail::shortest_paths_to<Heap>(g, src, target);
+	}
+
+} // namespace gdwg
+
+#endif
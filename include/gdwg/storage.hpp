@@ -0,0 +1,382 @@
+#ifndef GDWG_STORAGE_HPP
+#define GDWG_STORAGE_HPP
+
+#include "gdwg/memory_footprint.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace gdwg {
+	namespace detail {
+		// Sorted set that keeps its elements in a contiguous vector, searched by binary search, while
+		// it holds at most Threshold of them and in a std::set once it grows past that, or once a
+		// node extracted from a tree is inserted into it while it is empty. Once it has become a
+		// tree it stays one until it is emptied. Unlike std::set, inserting or erasing an
+		// element may invalidate every iterator into the set.
+		template<typename T, typename Compare, typename Alloc, std::size_t Threshold>
+		class adaptive_set {
+		private:
+			using flat_type = std::vector<T, Alloc>;
+			using tree_type = std::set<T, Compare, Alloc>;
+
+		public:
+			class const_iterator;
+			class node_type;
+			using iterator = const_iterator;
+			using value_type = T;
+			using size_type = std::size_t;
+			using key_compare = Compare;
+			using allocator_type = Alloc;
+			struct insert_return_type;
+
+			adaptive_set() = default;
+			explicit adaptive_set(Alloc const& alloc)
+			: flat_(alloc)
+			, tree_(alloc) {}
+			adaptive_set(adaptive_set const& other, Alloc const& alloc)
+			: flat_(other.flat_, alloc)
+			, tree_(other.tree_, alloc) {}
+			adaptive_set(adaptive_set&& other, Alloc const& alloc)
+			: flat_(std::move(other.flat_), alloc)
+			, tree_(std::move(other.tree_), alloc) {}
+
+			auto get_allocator() const noexcept -> allocator_type {
+				return flat_.get_allocator();
+			}
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return flat_.empty() && tree_.empty();
+			}
+			auto size() const noexcept -> size_type {
+				return is_flat() ? flat_.size() : tree_.size();
+			}
+
+			auto begin() const noexcept -> const_iterator {
+				return is_flat() ? const_iterator(flat_.begin()) : const_iterator(tree_.begin());
+			}
+			auto end() const noexcept -> const_iterator {
+				return is_flat() ? const_iterator(flat_.end()) : const_iterator(tree_.end());
+			}
+
+			template<typename K>
+			auto lower_bound(K const& key) const -> const_iterator {
+				if (is_flat()) {
+					return const_iterator(
+					   std::lower_bound(flat_.begin(), flat_.end(), key, tree_.key_comp()));
+				}
+				return const_iterator(tree_.lower_bound(key));
+			}
+			template<typename K>
+			auto upper_bound(K const& key) const -> const_iterator {
+				if (is_flat()) {
+					return const_iterator(
+					   std::upper_bound(flat_.begin(), flat_.end(), key, tree_.key_comp()));
+				}
+				return const_iterator(tree_.upper_bound(key));
+			}
+			template<typename K>
+			auto equal_range(K const& key) const -> std::pair<const_iterator, const_iterator> {
+				if (is_flat()) {
+					auto const [first, last] =
+					   std::equal_range(flat_.begin(), flat_.end(), key, tree_.key_comp());
+					return {const_iterator(first), const_iterator(last)};
+				}
+				auto const [first, last] = tree_.equal_range(key);
+				return {const_iterator(first), const_iterator(last)};
+			}
+			template<typename K>
+			auto find(K const& key) const -> const_iterator {
+				auto const search = lower_bound(key);
+				if (search == end() || tree_.key_comp()(key, *search)) {
+					return end();
+				}
+				return search;
+			}
+			template<typename K>
+			auto contains(K const& key) const -> bool {
+				return find(key) != end();
+			}
+
+			template<typename... Args>
+			auto emplace(Args&&... args) -> std::pair<const_iterator, bool> {
+				if (!is_flat()) {
+					auto const [iter, inserted] = tree_.emplace(std::forward<Args>(args)...);
+					return {const_iterator(iter), inserted};
+				}
+
+				auto value = T(std::forward<Args>(args)...);
+				auto const search =
+				   std::lower_bound(flat_.begin(), flat_.end(), value, tree_.key_comp());
+				if (search != flat_.end() && !tree_.key_comp()(value, *search)) {
+					return {const_iterator(search), false};
+				}
+				if (flat_.size() < Threshold) {
+					return {const_iterator(flat_.insert(search, std::move(value))), true};
+				}
+
+				// The vector is left untouched until the tree has been built, in case that throws.
+				auto tree = tree_type(flat_.begin(), flat_.end(), tree_.key_comp(), get_allocator());
+				auto const iter = tree.emplace_hint(tree.end(), std::move(value));
+				tree_.swap(tree);
+				flat_type(get_allocator()).swap(flat_);
+				return {const_iterator(iter), true};
+			}
+
+			// Appending in order costs O(1) while the set is flat, so sorted input builds quickly.
+			template<typename... Args>
+			auto emplace_hint(const_iterator hint, Args&&... args) -> const_iterator {
+				if (!is_flat()) {
+					return const_iterator(
+					   tree_.emplace_hint(hint.tree_iter_, std::forward<Args>(args)...));
+				}
+				auto value = T(std::forward<Args>(args)...);
+				if (hint == end() && flat_.size() < Threshold
+				    && (flat_.empty() || tree_.key_comp()(flat_.back(), value)))
+				{
+					flat_.emplace_back(std::move(value));
+					return const_iterator(std::prev(flat_.end()));
+				}
+				return emplace(std::move(value)).first;
+			}
+
+			auto erase(const_iterator pos) -> const_iterator {
+				if (is_flat()) {
+					return const_iterator(flat_.erase(pos.flat_iter_));
+				}
+				auto const next = tree_.erase(pos.tree_iter_);
+				return tree_.empty() ? end() : const_iterator(next);
+			}
+			auto erase(const_iterator first, const_iterator last) -> const_iterator {
+				if (is_flat()) {
+					return const_iterator(flat_.erase(first.flat_iter_, last.flat_iter_));
+				}
+				auto const next = tree_.erase(first.tree_iter_, last.tree_iter_);
+				return tree_.empty() ? end() : const_iterator(next);
+			}
+			template<typename K>
+			auto erase(K const& key) -> size_type {
+				auto const [first, last] = equal_range(key);
+				auto const count = static_cast<size_type>(std::distance(first, last));
+				erase(first, last);
+				return count;
+			}
+
+			// As with std::set, the element stays in the memory it was stored in: its tree node, or a
+			// slot of the vector, which keeps its capacity.
+			auto extract(const_iterator pos) -> node_type {
+				auto node = node_type();
+				if (is_flat()) {
+					auto const iter = flat_.begin() + (pos.flat_iter_ - flat_.cbegin());
+					node.flat_value_.emplace(std::move(*iter));
+					flat_.erase(iter);
+				}
+				else {
+					node.tree_node_ = tree_.extract(pos.tree_iter_);
+				}
+				node.alloc_.emplace(get_allocator());
+				return node;
+			}
+			// node has to come from a set with an equal allocator. A node extracted from a tree is
+			// relinked into a tree, or into an empty set, which becomes a tree; any other node has
+			// its element moved across.
+			auto insert(node_type&& node) -> insert_return_type {
+				if (node.empty()) {
+					return {end(), false, node_type()};
+				}
+				if (!node.tree_node_.empty() && (!is_flat() || flat_.empty())) {
+					auto result = tree_.insert(std::move(node.tree_node_));
+					auto rest = node_type();
+					if (!result.inserted) {
+						rest.tree_node_ = std::move(result.node);
+						rest.alloc_.emplace(*node.alloc_);
+					}
+					node.reset();
+					return {const_iterator(result.position), result.inserted, std::move(rest)};
+				}
+				auto const search = find(node.value());
+				if (search != end()) {
+					return {search, false, std::move(node)};
+				}
+				auto const iter = emplace(std::move(node.value())).first;
+				node.reset();
+				return {iter, true, node_type()};
+			}
+
+			auto clear() noexcept -> void {
+				flat_.clear();
+				tree_.clear();
+			}
+
+			// The vector counts by capacity, as it keeps its memory while it shrinks.
+			auto allocated_bytes() const noexcept -> std::size_t {
+				return flat_.capacity() * sizeof(T) + container_bytes(tree_);
+			}
+
+			class const_iterator {
+			public:
+				using value_type = T;
+				using reference = T const&;
+				using pointer = T const*;
+				using difference_type = std::ptrdiff_t;
+				using iterator_category = std::bidirectional_iterator_tag;
+
+				const_iterator() = default;
+
+				auto operator*() const -> reference {
+					return in_tree_ ? *tree_iter_ : *flat_iter_;
+				}
+				auto operator->() const -> pointer {
+					return &**this;
+				}
+
+				auto operator++() -> const_iterator& {
+					if (in_tree_) {
+						++tree_iter_;
+					}
+					else {
+						++flat_iter_;
+					}
+					return *this;
+				}
+				auto operator++(int) -> const_iterator {
+					auto before_iterator = *this;
+					++*this;
+					return before_iterator;
+				}
+				auto operator--() -> const_iterator& {
+					if (in_tree_) {
+						--tree_iter_;
+					}
+					else {
+						--flat_iter_;
+					}
+					return *this;
+				}
+				auto operator--(int) -> const_iterator {
+					auto before_iterator = *this;
+					--*this;
+					return before_iterator;
+				}
+
+				auto operator==(const_iterator const& other) const -> bool {
+					if (in_tree_ != other.in_tree_) {
+						return false;
+					}
+					return in_tree_ ? tree_iter_ == other.tree_iter_ : flat_iter_ == other.flat_iter_;
+				}
+
+			private:
+				friend class adaptive_set;
+				typename flat_type::const_iterator flat_iter_;
+				typename tree_type::const_iterator tree_iter_;
+				bool in_tree_ = false;
+
+				explicit const_iterator(typename flat_type::const_iterator iter)
+				: flat_iter_(iter) {}
+				explicit const_iterator(typename tree_type::const_iterator iter)
+				: tree_iter_(iter)
+				, in_tree_(true) {}
+			};
+
+			// An element taken out of the set by extract(), which insert() can put back.
+			class node_type {
+			public:
+				using value_type = T;
+				using allocator_type = Alloc;
+
+				node_type() = default;
+				node_type(node_type&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+				: tree_node_(std::move(other.tree_node_))
+				, flat_value_(std::move(other.flat_value_))
+				, alloc_(std::move(other.alloc_)) {
+					other.reset();
+				}
+				auto operator=(node_type&& other) noexcept(std::is_nothrow_move_assignable_v<T>)
+				   -> node_type& {
+					if (this != &other) {
+						tree_node_ = std::move(other.tree_node_);
+						flat_value_ = std::move(other.flat_value_);
+						// Allocators such as polymorphic_allocator cannot be assigned, only rebuilt.
+						alloc_.reset();
+						if (other.alloc_) {
+							alloc_.emplace(*other.alloc_);
+						}
+						other.reset();
+					}
+					return *this;
+				}
+				~node_type() = default;
+
+				[[nodiscard]] auto empty() const noexcept -> bool {
+					return !alloc_.has_value();
+				}
+				explicit operator bool() const noexcept {
+					return !empty();
+				}
+				auto get_allocator() const -> allocator_type {
+					return *alloc_;
+				}
+				auto value() const -> value_type& {
+					return tree_node_.empty() ? *flat_value_ : tree_node_.value();
+				}
+
+			private:
+				friend class adaptive_set;
+				typename tree_type::node_type tree_node_;
+				// Mutable because value() hands out a mutable element from a const handle, as
+				// std::set's node handles do.
+				mutable std::optional<T> flat_value_;
+				std::optional<Alloc> alloc_;
+
+				auto reset() noexcept -> void {
+					tree_node_ = typename tree_type::node_type();
+					flat_value_.reset();
+					alloc_.reset();
+				}
+			};
+			struct insert_return_type {
+				const_iterator position;
+				bool inserted;
+				node_type node;
+			};
+
+		private:
+			flat_type flat_;
+			tree_type tree_;
+
+			auto is_flat() const noexcept -> bool {
+				return tree_.empty();
+			}
+		};
+
+		template<typename T, typename Compare, typename Alloc, std::size_t Threshold>
+		auto container_bytes(adaptive_set<T, Compare, Alloc, Threshold> const& set) noexcept
+		   -> std::size_t {
+			return set.allocated_bytes();
+		}
+	} // namespace detail
+
+	// Storage policies for the per-node adjacency sets of gdwg::graph.
+	// tree_storage keeps every set in a std::set.
+	struct tree_storage {
+		template<typename T, typename Compare, typename Alloc>
+		using set_type = std::set<T, Compare, Alloc>;
+	};
+
+	// flat_storage keeps each set in a sorted vector until it holds more than Threshold elements,
+	// and in a std::set after that. Any edge insertion or erasure may invalidate graph iterators.
+	template<std::size_t Threshold = 16>
+	struct flat_storage {
+		template<typename T, typename Compare, typename Alloc>
+		using set_type = detail::adaptive_set<T, Compare, Alloc, Threshold>;
+	};
+
+} // namespace gdwg
+
+#endif
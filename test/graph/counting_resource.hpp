@@ -0,0 +1,38 @@
+#ifndef GDWG_TEST_COUNTING_RESOURCE_HPP
+#define GDWG_TEST_COUNTING_RESOURCE_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace {
+	// Forwards to new/delete, and counts how many allocations it has made and how many bytes are
+	// still outstanding, to check where a graph's memory comes from and whether it is reused.
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		[[nodiscard]] auto allocations() const -> std::size_t {
+			return allocations_;
+		}
+		[[nodiscard]] auto bytes_in_use() const -> std::size_t {
+			return bytes_in_use_;
+		}
+
+	private:
+		std::size_t allocations_ = 0;
+		std::size_t bytes_in_use_ = 0;
+
+		auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+			allocations_++;
+			bytes_in_use_ += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+		auto do_deallocate(void* p, std::size_t bytes, std::size_t alignment) -> void override {
+			bytes_in_use_ -= bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+} // namespace
+
+#endif
@@ -42,6 +42,38 @@ tested earlier as these were also heavily used testing almost everything.
 #include "gdwg/graph.hpp"
 
 #include <catch2/catch.hpp>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+	// Counts every construction of a node value, to check that lookups never build one.
+	struct counted_name {
+		static inline int constructions = 0;
+		std::string name;
+
+		explicit counted_name(std::string_view n)
+		: name(n) {
+			constructions++;
+		}
+		counted_name(counted_name const& other)
+		: name(other.name) {
+			constructions++;
+		}
+
+		friend auto operator<(counted_name const& a, counted_name const& b) -> bool {
+			return a.name < b.name;
+		}
+		friend auto operator<(counted_name const& a, std::string_view b) -> bool {
+			return a.name < b;
+		}
+		friend auto operator<(std::string_view a, counted_name const& b) -> bool {
+			return a < b.name;
+		}
+	};
+} // namespace
 
 TEST_CASE("is_node function") {
 	SECTION("integer nodes") {
@@ -123,6 +155,37 @@ TEST_CASE("is_connected function") {
 	}
 }
 
+TEST_CASE("is_connected_many") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "d", 3);
+	g.insert_edge("a", "a", 4);
+
+	SECTION("sorted destinations") {
+		auto const dsts = std::vector<std::string>{"a", "b", "c", "d", "e"};
+		CHECK(g.is_connected_many("a", dsts) == std::vector<bool>{true, true, false, true, false});
+		for (auto i = std::size_t{0}; i < dsts.size(); i++) {
+			CHECK(g.is_connected_many("a", dsts)[i] == g.is_connected("a", dsts[i]));
+		}
+	}
+
+	SECTION("repeated and missing destinations") {
+		auto const dsts = std::vector<std::string_view>{"0", "b", "b", "bb", "d", "z"};
+		CHECK(g.is_connected_many("a", dsts)
+		      == std::vector<bool>{false, true, true, false, true, false});
+	}
+
+	SECTION("source without edges") {
+		CHECK(g.is_connected_many("c", std::vector<std::string>{"a", "c"})
+		      == std::vector<bool>{false, false});
+		CHECK(g.is_connected_many("c", std::vector<std::string>{}).empty());
+		CHECK_THROWS_WITH(g.is_connected_many("f", std::vector<std::string>{"a"}),
+		                  "Cannot call gdwg::graph<N, E>::is_connected_many if src doesn't exist in "
+		                  "the graph");
+	}
+}
+
 TEST_CASE("nodes function") {
 	SECTION("integers") {
 		auto g = gdwg::graph<int, int>{3, 2, 1};
@@ -348,3 +411,243 @@ TEST_CASE("connections function") {
 		                  "graph");
 	}
 }
+
+TEST_CASE("heterogeneous lookup") {
+	SECTION("string literals and string_views") {
+		auto g = gdwg::graph<std::string, int>{"a", "bb", "ccc"};
+		CHECK(g.insert_edge("a", std::string_view("bb"), 1));
+		CHECK(g.insert_edge(std::string_view("ccc"), "a", 2));
+		CHECK(g.is_node("bb"));
+		CHECK(!g.is_node(std::string_view("d")));
+		CHECK(g.is_connected("a", "bb"));
+		CHECK(g.weights(std::string_view("ccc"), "a") == std::vector<int>{2});
+		CHECK(g.connections("a") == std::vector<std::string>{"bb"});
+		CHECK((*g.find("a", "bb", 1)).to == "bb");
+		CHECK_THROWS_WITH(g.weights("a", "d"),
+		                  "Cannot call gdwg::graph<N, E>::weights if src or dst node don't exist "
+		                  "in the graph");
+
+		auto c = g.freeze();
+		CHECK(c.is_node("bb"));
+		CHECK(c.is_connected(std::string_view("ccc"), "a"));
+		CHECK(c.weights("a", "bb") == std::vector<int>{1});
+		CHECK(c.connections("ccc") == std::vector<std::string>{"a"});
+		CHECK(c.find("a", std::string_view("bb"), 1) == c.begin());
+
+		CHECK(g.replace_node("bb", "b"));
+		g.merge_replace_node(std::string_view("ccc"), "b");
+		CHECK(g.erase_edge("a", "b", 1));
+		CHECK(g.erase_node("b"));
+		CHECK(g.nodes() == std::vector<std::string>{"a"});
+	}
+
+	SECTION("lookups do not construct nodes") {
+		auto g = gdwg::graph<counted_name, int>();
+		g.insert_node(counted_name("a"));
+		g.insert_node(counted_name("b"));
+		counted_name::constructions = 0;
+
+		CHECK(g.insert_edge("a", "b", 1));
+		CHECK(g.insert_edge("b", "b", 2));
+		CHECK(g.is_node("a"));
+		CHECK(!g.is_node("c"));
+		CHECK(g.is_connected("a", "b"));
+		CHECK(g.weights("b", "b") == std::vector<int>{2});
+		CHECK(g.find("a", "b", 1) != g.end());
+		CHECK(g.erase_edge("b", "b", 2));
+		g.merge_replace_node("b", "a");
+		CHECK(g.erase_node("a"));
+		CHECK(counted_name::constructions == 0);
+	}
+}
+
+TEST_CASE("node handles") {
+	auto g = gdwg::graph<std::string, int>{"a", "c"};
+	auto const a = g.handle("a");
+	auto const [b, inserted] = g.emplace_node("b");
+	auto const c = g.handle(std::string("c"));
+	REQUIRE(a);
+	REQUIRE(inserted);
+	REQUIRE(c);
+
+	SECTION("handle lookups") {
+		CHECK(g.handle("b") == b);
+		CHECK(g.emplace_node("a") == std::pair(a, false));
+		CHECK(!g.handle("d"));
+		CHECK(!decltype(g)::node_handle());
+	}
+
+	SECTION("edge operations") {
+		CHECK(g.insert_edge(a, b, 1));
+		CHECK(!g.insert_edge(a, b, 1));
+		CHECK(g.emplace_edge(a, b, 2));
+		CHECK(g.insert_edge(b, b, 3));
+		CHECK(g.is_connected(a, b));
+		CHECK(!g.is_connected(b, a));
+		CHECK(g.weights(a, b) == std::vector<int>{1, 2});
+		CHECK(g.weights(a, c).empty());
+		CHECK(g.find(a, b, 2) == g.find("a", "b", 2));
+		CHECK(g.find(a, b, 4) == g.end());
+		CHECK(g.erase_edge(a, b, 1));
+		CHECK(!g.erase_edge(a, b, 1));
+		CHECK(g.weights("a", "b") == std::vector<int>{2});
+	}
+
+	SECTION("handles survive changes to other nodes") {
+		g.insert_edge(a, c, 1);
+		CHECK(g.replace_node("b", "e"));
+		g.insert_node("bb");
+		CHECK(g.erase_node("bb"));
+		CHECK(g.insert_edge(c, a, 2));
+		CHECK(g.is_connected(a, c));
+		CHECK(g.connections("c") == std::vector<std::string>{"a"});
+
+		auto moved = std::move(g);
+		CHECK(moved.is_connected(c, a));
+	}
+
+	SECTION("empty handles") {
+		auto const none = decltype(g)::node_handle();
+		CHECK_THROWS_WITH(g.insert_edge(a, none, 1),
+		                  "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node "
+		                  "does not exist");
+		CHECK_THROWS_WITH(g.emplace_edge(none, a, 1),
+		                  "Cannot call gdwg::graph<N, E>::emplace_edge when either src or dst node "
+		                  "does not exist");
+		CHECK_THROWS_WITH(g.is_connected(none, a),
+		                  "Cannot call gdwg::graph<N, E>::is_connected if src or dst node don't "
+		                  "exist in the graph");
+		CHECK_THROWS_WITH(g.weights(a, g.handle("d")),
+		                  "Cannot call gdwg::graph<N, E>::weights if src or dst node don't exist in "
+		                  "the graph");
+		CHECK_THROWS_WITH(g.erase_edge(a, none, 1),
+		                  "Cannot call gdwg::graph<N, E>::erase_edge on src or dst if they don't "
+		                  "exist in the graph");
+		CHECK(g.find(none, a, 1) == g.end());
+	}
+}
+
+TEST_CASE("counts and degrees") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	CHECK(g.num_nodes() == 3);
+	CHECK(g.num_edges() == 0);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "c", 3);
+	g.insert_edge("c", "c", 4);
+	g.insert_edge("b", "a", 5);
+	CHECK(!g.insert_edge("a", "b", 1));
+
+	SECTION("after insertion") {
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree("a") == 3);
+		CHECK(g.in_degree("a") == 1);
+		CHECK(g.in_degree("b") == 2);
+		CHECK(g.out_degree("c") == 1);
+		CHECK(g.in_degree("c") == 2);
+		CHECK(g.out_degree(g.handle("a")) == 3);
+		CHECK(g.in_degree(g.handle("c")) == 2);
+	}
+
+	SECTION("after erasing edges") {
+		CHECK(g.erase_edge("a", "b", 1));
+		g.erase_edge(g.find("a", "b", 2), g.find("c", "c", 4));
+		CHECK(g.num_edges() == 1);
+		CHECK(g.out_degree("a") == 0);
+		CHECK(g.out_degree("b") == 0);
+		CHECK(g.in_degree("a") == 0);
+		CHECK(g.in_degree("b") == 0);
+		CHECK(g.in_degree("c") == 1);
+	}
+
+	SECTION("after node modifiers") {
+		CHECK(g.replace_node("c", "d"));
+		CHECK(g.out_degree("d") == 1);
+		CHECK(g.in_degree("d") == 2);
+		g.merge_replace_node("b", "d");
+		CHECK(g.num_nodes() == 2);
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree("a") == 3);
+		CHECK(g.in_degree("d") == 4);
+		CHECK(g.erase_node("d"));
+		CHECK(g.num_edges() == 0);
+		CHECK(g.out_degree("a") == 0);
+	}
+
+	SECTION("copies, moves and clear") {
+		auto copy = g;
+		CHECK(copy.num_edges() == 5);
+		CHECK(copy.in_degree("c") == 2);
+		auto moved = std::move(copy);
+		CHECK(moved.num_edges() == 5);
+		CHECK(copy.num_edges() == 0);
+		moved.clear();
+		CHECK(moved.num_nodes() == 0);
+		CHECK(moved.num_edges() == 0);
+	}
+
+	SECTION("missing nodes") {
+		CHECK_THROWS_WITH(g.out_degree("e"),
+		                  "Cannot call gdwg::graph<N, E>::out_degree on a node that doesn't exist");
+		CHECK_THROWS_WITH(g.in_degree(decltype(g)::node_handle()),
+		                  "Cannot call gdwg::graph<N, E>::in_degree on a node that doesn't exist");
+	}
+}
+
+TEST_CASE("range views") {
+	using graph_t = gdwg::graph<std::string, int>;
+	auto g = graph_t{"a", "b", "c", "d"};
+	g.insert_edge("a", "c", 3);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "a", 4);
+	g.insert_edge("c", "b", 5);
+
+	STATIC_REQUIRE(std::ranges::view<decltype(g.nodes_view())>);
+	STATIC_REQUIRE(std::ranges::view<decltype(g.out_edges("a"))>);
+	STATIC_REQUIRE(std::ranges::view<decltype(g.connections_view("a"))>);
+	STATIC_REQUIRE(std::ranges::view<decltype(g.weights_view("a", "b"))>);
+
+	SECTION("nodes_view") {
+		auto const view = g.nodes_view();
+		CHECK(std::vector<std::string>(view.begin(), view.end()) == g.nodes());
+		CHECK(&*view.begin() == &*g.nodes_view().begin());
+		CHECK(graph_t().nodes_view().empty());
+	}
+
+	SECTION("out_edges") {
+		auto edges = std::vector<std::pair<std::string, int>>{};
+		for (auto const& [to, weight] : g.out_edges("a")) {
+			edges.emplace_back(to, weight);
+		}
+		auto const expected =
+		   std::vector<std::pair<std::string, int>>{{"a", 4}, {"b", 1}, {"b", 2}, {"c", 3}};
+		CHECK(edges == expected);
+		CHECK(g.out_edges("b").empty());
+		CHECK(std::ranges::distance(g.out_edges("c")) == 1);
+		CHECK_THROWS_WITH(g.out_edges("e"),
+		                  "Cannot call gdwg::graph<N, E>::out_edges if src doesn't exist in the "
+		                  "graph");
+	}
+
+	SECTION("connections_view") {
+		auto const view = g.connections_view("a");
+		CHECK(std::vector<std::string>(view.begin(), view.end()) == g.connections("a"));
+		CHECK(g.connections_view("d").empty());
+		CHECK(*g.connections_view("c").begin() == "b");
+		CHECK_THROWS_WITH(g.connections_view("e"),
+		                  "Cannot call gdwg::graph<N, E>::connections_view if src doesn't exist in "
+		                  "the graph");
+	}
+
+	SECTION("weights_view") {
+		auto const view = g.weights_view("a", "b");
+		CHECK(std::vector<int>(view.begin(), view.end()) == std::vector<int>{1, 2});
+		CHECK(g.weights_view("a", "d").empty());
+		CHECK(g.weights_view("d", "a").empty());
+		CHECK(std::ranges::distance(g.weights_view(std::string_view("a"), "a")) == 1);
+		CHECK_THROWS_WITH(g.weights_view("a", "e"),
+		                  "Cannot call gdwg::graph<N, E>::weights_view if src or dst node don't "
+		                  "exist in the graph");
+	}
+}
\ No newline at end of file
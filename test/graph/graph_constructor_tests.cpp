@@ -41,8 +41,11 @@ tested earlier as these were also heavily used testing almost everything.
 */
 #include "gdwg/graph.hpp"
 
+#include "counting_resource.hpp"
+
 #include <catch2/catch.hpp>
 #include <list>
+#include <memory_resource>
 
 TEST_CASE("Default Constructor") {
 	SECTION("default") {
@@ -100,6 +103,48 @@ TEST_CASE("Iterator Constructor") {
 	}
 }
 
+TEST_CASE("Edge List Constructor") {
+	using graph_t = gdwg::graph<std::string, int>;
+
+	SECTION("empty") {
+		auto g = graph_t(std::vector<graph_t::value_type>{});
+		CHECK(g.empty());
+		CHECK(g.begin() == g.end());
+	}
+
+	SECTION("creates nodes and drops duplicate edges") {
+		auto const edges = std::vector<graph_t::value_type>{
+		   {"c", "a", 4},
+		   {"a", "b", 2},
+		   {"a", "b", 1},
+		   {"c", "a", 4},
+		   {"a", "a", 3},
+		   {"d", "b", 2},
+		};
+		auto g = graph_t(edges);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(g.weights("a", "b") == std::vector<int>{1, 2});
+		CHECK(g.weights("c", "a") == std::vector<int>{4});
+		CHECK(g.connections("a") == std::vector<std::string>{"a", "b"});
+
+		auto expected = graph_t{"a", "b", "c", "d"};
+		for (auto const& [from, to, weight] : edges) {
+			expected.insert_edge(from, to, weight);
+		}
+		CHECK(g == expected);
+		CHECK(g.erase_node("b"));
+		CHECK(g.connections("d").empty());
+	}
+
+	SECTION("from another graph's edges") {
+		auto g = gdwg::graph<int, int>{1, 2, 3};
+		g.insert_edge(3, 1, 2);
+		g.insert_edge(1, 2, 5);
+		auto g2 = gdwg::graph<int, int>(std::vector(g.begin(), g.end()));
+		CHECK(g2 == g);
+	}
+}
+
 TEST_CASE("Move Constructor") {
 	SECTION("empty") {
 		auto g = gdwg::graph<int, int>{1};
@@ -258,4 +303,95 @@ TEST_CASE("Copy Assignment") {
 		CHECK(v.at(0) == 5);
 		CHECK(v.at(1) == 10);
 	}
-}
\ No newline at end of file
+
+	SECTION("replaces the previous contents") {
+		auto g = gdwg::graph<int, int>{1, 2};
+		g.insert_edge(1, 2, 3);
+		auto g2 = gdwg::graph<int, int>{0, 2, 4};
+		g2.insert_edge(2, 0, 1);
+		g2.insert_edge(4, 4, 1);
+		g2 = g;
+		CHECK(g2 == g);
+		CHECK(g2.nodes() == std::vector<int>{1, 2});
+		CHECK(g2.connections(2).empty());
+	}
+
+	SECTION("the copy is independent and stays ordered") {
+		auto g = gdwg::graph<std::string, int>{"a", "c", "e", "g"};
+		g.erase_node("c");
+		g.insert_edge("a", "e", 1);
+		g.insert_edge("g", "a", 2);
+		g.insert_edge("g", "e", 3);
+		auto g2 = gdwg::graph<std::string, int>();
+		g2 = g;
+		g2.insert_node("f");
+		g2.insert_node("b");
+		g2.insert_edge("g", "f", 4);
+		g2.insert_edge("g", "b", 5);
+		CHECK(g2.connections("g") == std::vector<std::string>{"a", "b", "e", "f"});
+		CHECK(g.connections("g") == std::vector<std::string>{"a", "e"});
+		CHECK(g2.erase_node("a"));
+		CHECK(g.is_connected("g", "a"));
+	}
+
+	SECTION("flat storage") {
+		auto g = gdwg::flat_graph<int, int, 1>{1, 2, 3};
+		g.insert_edge(1, 2, 1);
+		g.insert_edge(1, 3, 1);
+		g.insert_edge(2, 3, 1);
+		auto g2 = g;
+		CHECK(g2 == g);
+		CHECK(g2.connections(1) == std::vector<int>{2, 3});
+		auto const g3 = gdwg::flat_graph<int, int, 1>{4};
+		g2 = g3;
+		CHECK(g2.nodes() == std::vector<int>{4});
+		CHECK(g2.begin() == g2.end());
+	}
+}
+
+TEST_CASE("Allocator-aware graph") {
+	SECTION("every allocation goes through the memory resource") {
+		auto resource = counting_resource();
+		auto* const previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+		{
+			auto g = gdwg::pmr::graph<int, int>({1, 2, 3}, &resource);
+			CHECK(g.get_allocator().resource() == &resource);
+			g.insert_edge(1, 2, 5);
+			g.insert_edge(2, 3, 1);
+			g.insert_edge(3, 3, 7);
+			g.replace_node(3, 4);
+			g.merge_replace_node(1, 2);
+			auto g2 = gdwg::pmr::graph<int, int>(g, &resource);
+			CHECK(g2 == g);
+			CHECK(resource.bytes_in_use() > 0);
+		}
+		std::pmr::set_default_resource(previous);
+		CHECK(resource.bytes_in_use() == 0);
+	}
+
+	SECTION("bulk load into a monotonic arena") {
+		auto arena = std::pmr::monotonic_buffer_resource();
+		auto g = gdwg::pmr::graph<int, int>(&arena);
+		for (auto i = 0; i < 100; i++) {
+			g.insert_node(i);
+		}
+		for (auto i = 1; i < 100; i++) {
+			g.insert_edge(i - 1, i, i);
+		}
+		CHECK(g.weights(41, 42) == std::vector<int>{42});
+		CHECK(g.get_allocator().resource() == &arena);
+	}
+
+	SECTION("move assignment across resources copies the contents") {
+		auto resource = counting_resource();
+		auto other_resource = counting_resource();
+		auto g = gdwg::pmr::graph<int, int>({1, 2}, &resource);
+		g.insert_edge(1, 2, 3);
+		auto g2 = gdwg::pmr::graph<int, int>(&other_resource);
+		g2 = std::move(g);
+		CHECK(g.empty());
+		CHECK(resource.bytes_in_use() == 0);
+		CHECK(g2.get_allocator().resource() == &other_resource);
+		CHECK(g2.weights(1, 2) == std::vector<int>{3});
+	}
+}
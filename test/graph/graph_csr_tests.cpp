@@ -0,0 +1,123 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("freeze") {
+	SECTION("empty graph") {
+		auto g = gdwg::graph<int, int>();
+		auto c = g.freeze();
+		CHECK(c.empty());
+		CHECK(c.begin() == c.end());
+		CHECK(c.nodes().empty());
+	}
+
+	SECTION("nodes without edges") {
+		auto g = gdwg::graph<int, int>{3, 1, 2};
+		auto c = g.freeze();
+		CHECK(!c.empty());
+		CHECK(c.nodes() == std::vector<int>{1, 2, 3});
+		CHECK(c.begin() == c.end());
+		CHECK(c.connections(2).empty());
+	}
+
+	SECTION("iteration order matches the graph") {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+		g.insert_edge("c", "a", 4);
+		g.insert_edge("a", "b", 2);
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("a", "a", 9);
+		g.insert_edge("d", "c", 3);
+		auto c = g.freeze();
+
+		auto g_iter = g.begin();
+		for (auto const& [from, to, weight] : c) {
+			REQUIRE(g_iter != g.end());
+			CHECK(from == (*g_iter).from);
+			CHECK(to == (*g_iter).to);
+			CHECK(weight == (*g_iter).weight);
+			g_iter++;
+		}
+		CHECK(g_iter == g.end());
+
+		auto c_iter = c.end();
+		c_iter--;
+		CHECK((*c_iter).from == "d");
+		CHECK((*c_iter).to == "c");
+		--c_iter;
+		CHECK((*c_iter).from == "c");
+		--c_iter;
+		--c_iter;
+		--c_iter;
+		CHECK(c_iter == c.begin());
+	}
+}
+
+TEST_CASE("csr_graph accessors") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+	g.insert_edge(1, 2, 5);
+	g.insert_edge(1, 2, 3);
+	g.insert_edge(1, 4, 7);
+	g.insert_edge(3, 1, 2);
+	auto c = g.freeze();
+
+	SECTION("is_node") {
+		CHECK(c.is_node(1));
+		CHECK(c.is_node(4));
+		CHECK(!c.is_node(5));
+	}
+
+	SECTION("is_connected") {
+		CHECK(c.is_connected(1, 2));
+		CHECK(c.is_connected(3, 1));
+		CHECK(!c.is_connected(2, 1));
+		CHECK(!c.is_connected(4, 4));
+		CHECK_THROWS_WITH(c.is_connected(1, 10),
+		                  "Cannot call gdwg::csr_graph<N, E>::is_connected if src or dst node don't "
+		                  "exist in the graph");
+	}
+
+	SECTION("weights") {
+		CHECK(c.weights(1, 2) == std::vector<int>{3, 5});
+		CHECK(c.weights(1, 4) == std::vector<int>{7});
+		CHECK(c.weights(2, 1).empty());
+		CHECK_THROWS_WITH(c.weights(10, 1),
+		                  "Cannot call gdwg::csr_graph<N, E>::weights if src or dst node don't exist "
+		                  "in the graph");
+	}
+
+	SECTION("connections") {
+		CHECK(c.connections(1) == std::vector<int>{2, 4});
+		CHECK(c.connections(2).empty());
+		CHECK_THROWS_WITH(c.connections(10),
+		                  "Cannot call gdwg::csr_graph<N, E>::connections if src doesn't exist in "
+		                  "the graph");
+	}
+
+	SECTION("find") {
+		auto iter = c.find(1, 4, 7);
+		CHECK((*iter).from == 1);
+		CHECK((*iter).to == 4);
+		CHECK((*iter).weight == 7);
+		CHECK(++iter == c.find(3, 1, 2));
+		CHECK(c.find(1, 2, 4) == c.end());
+		CHECK(c.find(1, 10, 4) == c.end());
+	}
+
+	SECTION("extractor matches the graph") {
+		auto g_out = std::ostringstream{};
+		auto c_out = std::ostringstream{};
+		g_out << g;
+		c_out << c;
+		CHECK(g_out.str() == c_out.str());
+	}
+
+	SECTION("snapshot is unaffected by later changes") {
+		g.erase_node(1);
+		CHECK(c.is_node(1));
+		CHECK(c.is_connected(1, 2));
+		CHECK_FALSE(c == g.freeze());
+	}
+}
@@ -42,7 +42,13 @@ tested earlier as these were also heavily used testing almost everything.
 
 #include "gdwg/graph.hpp"
 
+#include <atomic>
 #include <catch2/catch.hpp>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
 
 TEST_CASE("iterator begin") {
 	SECTION("integer") {
@@ -470,4 +476,178 @@ TEST_CASE("iterator preincrement--") {
 		CHECK(iter == g.begin());
 		CHECK(iter2 == g.begin());
 	}
+}
+
+TEST_CASE("iterator references") {
+	using graph_t = gdwg::graph<std::string, int>;
+	STATIC_REQUIRE(std::bidirectional_iterator<graph_t::iterator>);
+	STATIC_REQUIRE(std::same_as<std::iter_reference_t<graph_t::iterator>, graph_t::edge_reference>);
+
+	auto g = graph_t{"a", "b", "c"};
+	g.insert_edge("a", "b", 3);
+	g.insert_edge("c", "a", 1);
+	g.insert_edge("a", "b", 2);
+
+	SECTION("dereferencing refers into the graph") {
+		auto const iter = g.begin();
+		CHECK(&(*iter).from == &(*g.find("a", "b", 3)).from);
+		CHECK(&(*iter).from == &(*std::next(g.begin(), 2)).to);
+		CHECK(&(*iter).weight == &(*g.begin()).weight);
+	}
+
+	SECTION("structured bindings") {
+		auto edges = std::vector<std::tuple<std::string, std::string, int>>{};
+		for (auto const& [from, to, weight] : g) {
+			edges.emplace_back(from, to, weight);
+		}
+		for (auto [from, to, weight] : g) {
+			CHECK(g.find(from, to, weight) != g.end());
+		}
+		CHECK(edges
+		      == std::vector<std::tuple<std::string, std::string, int>>{{"a", "b", 2},
+		                                                                {"a", "b", 3},
+		                                                                {"c", "a", 1}});
+	}
+
+	SECTION("converts to value_type") {
+		graph_t::value_type const copy = *g.begin();
+		g.erase_edge(g.begin());
+		CHECK(copy.from == "a");
+		CHECK(copy.to == "b");
+		CHECK(copy.weight == 2);
+	}
+}
+
+TEST_CASE("for_each visitors") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("c", "a", 4);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "c", 3);
+
+	SECTION("for_each_edge visits edges in iteration order") {
+		auto visited = std::vector<std::tuple<std::string, std::string, int>>{};
+		auto const completed =
+		   g.for_each_edge([&](std::string const& from, std::string const& to, int weight) {
+			   visited.emplace_back(from, to, weight);
+		   });
+		CHECK(completed);
+		auto expected = std::vector<std::tuple<std::string, std::string, int>>{};
+		for (auto const& [from, to, weight] : g) {
+			expected.emplace_back(from, to, weight);
+		}
+		CHECK(visited == expected);
+	}
+
+	SECTION("for_each_edge passes references into the graph") {
+		auto const& first = (*g.begin()).from;
+		g.for_each_edge([&](std::string const& from, std::string const&, int const&) {
+			CHECK(&from == &first);
+			return false;
+		});
+	}
+
+	SECTION("early exit") {
+		auto count = 0;
+		CHECK(!g.for_each_edge([&](auto const&, auto const&, int weight) {
+			count++;
+			return weight != 3;
+		}));
+		CHECK(count == 3);
+		CHECK(!g.for_each_node([](std::string const& node) { return node != "b"; }));
+		CHECK(g.for_each_out_edge("a", [](std::string const&, int weight) { return weight < 4; }));
+	}
+
+	SECTION("for_each_out_edge") {
+		auto weights = std::vector<int>{};
+		CHECK(g.for_each_out_edge("a", [&](std::string const&, int weight) {
+			weights.push_back(weight);
+		}));
+		CHECK(weights == std::vector<int>{1, 2, 3});
+		CHECK(g.for_each_out_edge("d", [](std::string const&, int) { return false; }));
+		CHECK_THROWS_WITH(g.for_each_out_edge("e", [](std::string const&, int) {}),
+		                  "Cannot call gdwg::graph<N, E>::for_each_out_edge if src doesn't exist in "
+		                  "the graph");
+	}
+
+	SECTION("for_each_node") {
+		auto nodes = std::vector<std::string>{};
+		CHECK(g.for_each_node([&](std::string const& node) { nodes.push_back(node); }));
+		CHECK(nodes == g.nodes());
+	}
+}
+
+TEST_CASE("parallel edge visitors") {
+	auto g = gdwg::graph<int, int>{};
+	for (auto node = 0; node < 50; node++) {
+		g.insert_node(node);
+	}
+	auto expected_sum = 0L;
+	for (auto src = 0; src < 50; src++) {
+		// Uneven out-degrees, so that the runs have to be balanced by edge count.
+		for (auto i = 0; i < (src % 7) * (src % 5); i++) {
+			auto const dst = (src * 13 + i) % 50;
+			if (g.insert_edge(src, dst, i)) {
+				expected_sum += src + dst + i;
+			}
+		}
+	}
+	auto const num_threads = GENERATE(0U, 1U, 3U, 8U, 200U);
+
+	SECTION("parallel_for_each_edge visits every edge once") {
+		auto sum = std::atomic<long>{0};
+		auto count = std::atomic<std::size_t>{0};
+		g.parallel_for_each_edge(
+		   [&](int from, int to, int weight) {
+			   sum += from + to + weight;
+			   count++;
+		   },
+		   num_threads);
+		CHECK(sum == expected_sum);
+		CHECK(count == g.num_edges());
+	}
+
+	SECTION("parallel_reduce_edges keeps iteration order") {
+		auto const sum = g.parallel_reduce_edges(
+		   0L,
+		   [](long a, long b) { return a + b; },
+		   [](int from, int to, int weight) { return static_cast<long>(from + to + weight); },
+		   num_threads);
+		CHECK(sum == expected_sum);
+
+		auto sequential = std::vector<int>{-1};
+		for (auto const& [from, to, weight] : g) {
+			sequential.push_back(from * 100 + to);
+		}
+		auto const concatenated = g.parallel_reduce_edges(
+		   std::vector<int>{-1},
+		   [](std::vector<int> a, std::vector<int> const& b) {
+			   a.insert(a.end(), b.begin(), b.end());
+			   return a;
+		   },
+		   [](int from, int to, int) { return std::vector<int>{from * 100 + to}; },
+		   num_threads);
+		CHECK(concatenated == sequential);
+	}
+
+	SECTION("empty graphs") {
+		auto const empty = gdwg::graph<int, int>{1, 2};
+		CHECK(empty.parallel_reduce_edges(
+		         5,
+		         [](int a, int b) { return a + b; },
+		         [](int, int, int weight) { return weight; },
+		         num_threads)
+		      == 5);
+	}
+
+	SECTION("exceptions reach the caller") {
+		CHECK_THROWS_WITH(g.parallel_for_each_edge(
+		                     [](int from, int, int) {
+			                     if (from == 44) {
+				                     throw std::runtime_error("visited 44");
+			                     }
+		                     },
+		                     num_threads),
+		                  "visited 44");
+	}
 }
\ No newline at end of file
@@ -42,7 +42,18 @@ tested earlier as these were also heavily used testing almost everything.
 
 #include "gdwg/graph.hpp"
 
+#include "counting_resource.hpp"
+
 #include <catch2/catch.hpp>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 TEST_CASE("insert_node") {
 	SECTION("integer nodes") {
@@ -75,6 +86,52 @@ TEST_CASE("insert_node") {
 		CHECK(v.size() == 1);
 		CHECK(v[0] == std::string("what"));
 	}
+
+	SECTION("many nodes inserted into the same gap keep edges in value order") {
+		auto g = gdwg::graph<int, int>{0, 100000};
+		g.insert_edge(0, 100000, 0);
+		g.insert_edge(100000, 0, 0);
+		// Each new node lands directly after 0, so the rank gap there keeps running out.
+		for (auto value = 99999; value > 99000; value--) {
+			CHECK(g.insert_node(value));
+			g.insert_edge(0, value, value);
+			g.insert_edge(100000, value, 0);
+		}
+
+		auto expected = std::vector<int>{};
+		for (auto value = 99001; value <= 100000; value++) {
+			expected.push_back(value);
+		}
+		CHECK(g.connections(0) == expected);
+		expected.insert(expected.begin(), 0);
+		expected.pop_back();
+		CHECK(g.connections(100000) == expected);
+		CHECK(g.weights(0, 99500) == std::vector<int>{99500});
+
+		auto prev = -1;
+		for (auto const& [from, to, weight] : g) {
+			if (from == 0) {
+				CHECK(prev < to);
+				prev = to;
+			}
+		}
+		CHECK(g.freeze().connections(0) == g.connections(0));
+	}
+
+	SECTION("erased nodes' slots are reused") {
+		auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+		g.insert_edge("a", "c", 1);
+		CHECK(g.erase_node("b"));
+		CHECK(g.insert_node("d"));
+		CHECK(g.insert_node("b"));
+		g.insert_edge("d", "b", 2);
+		g.insert_edge("b", "a", 3);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		auto c = g.freeze();
+		CHECK(c.connections("d") == std::vector<std::string>{"b"});
+		CHECK(c.weights("b", "a") == std::vector<int>{3});
+		CHECK(c.weights("a", "c") == std::vector<int>{1});
+	}
 }
 
 TEST_CASE("insert_edge") {
@@ -184,6 +241,228 @@ TEST_CASE("insert_edge") {
 	}
 }
 
+TEST_CASE("insert_edges") {
+	using graph_t = gdwg::graph<int, int>;
+
+	SECTION("merges into existing nodes and edges") {
+		auto g = graph_t{2, 4, 6};
+		g.insert_edge(2, 4, 1);
+		g.insert_edge(6, 2, 1);
+		auto const added = g.insert_edges(std::vector<graph_t::value_type>{
+		   {2, 4, 1},
+		   {2, 4, 0},
+		   {5, 4, 1},
+		   {6, 2, 1},
+		   {6, 2, 1},
+		   {4, 1, 7},
+		});
+		CHECK(added == 3);
+		CHECK(g.nodes() == std::vector<int>{1, 2, 4, 5, 6});
+		CHECK(g.weights(2, 4) == std::vector<int>{0, 1});
+		CHECK(g.connections(4) == std::vector<int>{1});
+		CHECK(g.connections(5) == std::vector<int>{4});
+
+		CHECK(g.erase_node(4));
+		CHECK(g.connections(2).empty());
+		CHECK(g.connections(5).empty());
+		CHECK(g.weights(6, 2) == std::vector<int>{1});
+	}
+
+	SECTION("nothing new") {
+		auto g = graph_t{1, 2};
+		g.insert_edge(1, 2, 3);
+		auto const copy = g;
+		CHECK(g.insert_edges(std::vector<graph_t::value_type>{{1, 2, 3}}) == 0);
+		CHECK(g.insert_edges(std::vector<graph_t::value_type>{}) == 0);
+		CHECK(g == copy);
+	}
+
+	SECTION("many edges match one at a time insertion") {
+		auto edges = std::vector<graph_t::value_type>{};
+		for (auto i = 0; i < 2000; i++) {
+			edges.push_back({(i * 7919) % 301, (i * 104729) % 257, i % 5});
+		}
+		auto g = graph_t(edges);
+		auto expected = graph_t{};
+		for (auto const& [from, to, weight] : edges) {
+			expected.insert_node(from);
+			expected.insert_node(to);
+			expected.insert_edge(from, to, weight);
+		}
+		CHECK(g == expected);
+		auto more = std::vector<graph_t::value_type>(edges.begin() + 1000, edges.end());
+		edges.resize(1000);
+		auto g2 = graph_t(edges);
+		g2.insert_edges(more);
+		CHECK(g2 == expected);
+	}
+
+	SECTION("a small batch scattered through a large graph") {
+		auto g = graph_t{};
+		for (auto i = 0; i < 3000; i += 2) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < 3000; i += 6) {
+			g.insert_edge(i, (i + 600) % 3000, 1);
+			g.insert_edge(i, (i + 600) % 3000, 3);
+		}
+		auto expected = g;
+		auto const batch = std::vector<graph_t::value_type>{
+		   {0, 600, 2},
+		   {2, 4, 1},
+		   {2, 1201, 1},
+		   {1201, 2, 1},
+		   {1500, 2998, 5},
+		   {2998, 0, 5},
+		   {2999, 2999, 1},
+		};
+		for (auto const& [from, to, weight] : batch) {
+			expected.insert_node(from);
+			expected.insert_node(to);
+			expected.insert_edge(from, to, weight);
+		}
+		CHECK(g.insert_edges(batch) == batch.size());
+		CHECK(g == expected);
+		CHECK(g.weights(0, 600) == std::vector<int>{1, 2, 3});
+		CHECK(g.in_degree(2) == 1);
+		CHECK(g.erase_node(1201));
+		CHECK(g.connections(2) == std::vector<int>{4});
+	}
+}
+
+namespace {
+	// Counts copies and moves of a node or weight, to check that values are built in place.
+	struct counted_value {
+		static inline int copies = 0;
+		static inline int moves = 0;
+		std::string name;
+		int number = 0;
+
+		counted_value(std::string n, int num)
+		: name(std::move(n))
+		, number(num) {}
+		counted_value(counted_value const& other)
+		: name(other.name)
+		, number(other.number) {
+			copies++;
+		}
+		counted_value(counted_value&& other) noexcept
+		: name(std::move(other.name))
+		, number(other.number) {
+			moves++;
+		}
+		auto operator=(counted_value const&) -> counted_value& = default;
+		auto operator=(counted_value&&) noexcept -> counted_value& = default;
+		~counted_value() = default;
+
+		friend auto operator<(counted_value const& a, counted_value const& b) -> bool {
+			return a.name < b.name || (a.name == b.name && a.number < b.number);
+		}
+	};
+
+	struct move_only_name {
+		std::unique_ptr<std::string> name;
+
+		explicit move_only_name(std::string n)
+		: name(std::make_unique<std::string>(std::move(n))) {}
+
+		friend auto operator<(move_only_name const& a, move_only_name const& b) -> bool {
+			return *a.name < *b.name;
+		}
+		friend auto operator<(move_only_name const& a, std::string const& b) -> bool {
+			return *a.name < b;
+		}
+		friend auto operator<(std::string const& a, move_only_name const& b) -> bool {
+			return a < *b.name;
+		}
+	};
+} // namespace
+
+TEST_CASE("emplace_node and emplace_edge") {
+	counted_value::copies = 0;
+	counted_value::moves = 0;
+
+	SECTION("insert_node(N&&) moves the value in") {
+		auto g = gdwg::graph<counted_value, int>{};
+		auto value = counted_value("a", 1);
+		CHECK(g.insert_node(std::move(value)));
+		CHECK(counted_value::copies == 0);
+		CHECK(counted_value::moves == 1);
+		CHECK(g.is_node(counted_value("a", 1)));
+	}
+
+	SECTION("insert_node(N&&) leaves a duplicate untouched") {
+		auto g = gdwg::graph<std::string, int>{"a"};
+		auto value = std::string("a");
+		CHECK(!g.insert_node(std::move(value)));
+		CHECK(value == "a");
+	}
+
+	SECTION("emplace_node constructs in place") {
+		auto g = gdwg::graph<counted_value, int>{};
+		CHECK(g.emplace_node("a", 1).second);
+		CHECK(g.emplace_node("a", 2).second);
+		CHECK(!g.emplace_node("a", 1).second);
+		CHECK(counted_value::copies == 0);
+		CHECK(counted_value::moves == 0);
+		CHECK(g.is_node(counted_value("a", 2)));
+	}
+
+	SECTION("a rejected emplace_node leaves the graph unchanged") {
+		auto g = gdwg::graph<std::string, int>{"a", "c"};
+		CHECK(!g.emplace_node("a").second);
+		CHECK(g.emplace_node(1, 'b').second);
+		g.insert_edge("b", "c", 1);
+		CHECK(g.freeze().nodes() == std::vector<std::string>{"a", "b", "c"});
+	}
+
+	SECTION("insert_edge(E&&) and emplace_edge") {
+		auto g = gdwg::graph<int, counted_value>{1, 2};
+		CHECK(g.insert_edge(1, 2, counted_value("x", 1)));
+		CHECK(counted_value::copies == 0);
+		CHECK(counted_value::moves == 1);
+		CHECK(g.emplace_edge(1, 2, "x", 2));
+		CHECK(!g.emplace_edge(1, 2, "x", 1));
+		CHECK(counted_value::copies == 0);
+		CHECK(counted_value::moves == 1);
+		CHECK(g.find(1, 2, counted_value("x", 2)) != g.end());
+		CHECK_THROWS_WITH(g.emplace_edge(1, 3, "x", 3),
+		                  "Cannot call gdwg::graph<N, E>::emplace_edge when either src or dst node "
+		                  "does not exist");
+	}
+
+	SECTION("move-only nodes") {
+		auto g = gdwg::graph<move_only_name, int>{};
+		CHECK(g.insert_node(move_only_name("b")));
+		CHECK(g.emplace_node("a").second);
+		CHECK(!g.emplace_node("b").second);
+		CHECK(g.insert_edge(std::string("a"), std::string("b"), 1));
+		CHECK(g.emplace_edge(std::string("b"), std::string("b"), 2));
+		CHECK(g.replace_node(std::string("b"), move_only_name("c")));
+		CHECK(g.is_connected(std::string("a"), std::string("c")));
+		CHECK(g.is_connected(std::string("c"), std::string("c")));
+		CHECK(!g.is_node(std::string("b")));
+		g.merge_replace_node(std::string("c"), std::string("a"));
+		CHECK(g.is_connected(std::string("a"), std::string("a")));
+		CHECK(g.erase_node(std::string("a")));
+		CHECK(g.empty());
+	}
+
+	SECTION("pmr node values use the graph's resource") {
+		auto resource = std::pmr::monotonic_buffer_resource();
+		auto* const previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+		{
+			auto const name = std::string_view("a node name that is too long for the string buffer");
+			auto g = gdwg::pmr::graph<std::pmr::string, int>(&resource);
+			CHECK(g.emplace_node(name).second);
+			CHECK(g.insert_node(
+			   std::pmr::string("another node name that is too long for the buffer", &resource)));
+			CHECK(g.is_node(name));
+		}
+		std::pmr::set_default_resource(previous);
+	}
+}
+
 TEST_CASE("replace_node") {
 	SECTION("replacing integer nodes") {
 		auto g = gdwg::graph<int, int>();
@@ -352,6 +631,23 @@ TEST_CASE("replace_node") {
 		CHECK(!completed);
 	}
 
+	SECTION("replacing a node with a self-loop") {
+		auto g = gdwg::graph<int, int>{1, 2, 3};
+		g.insert_edge(2, 2, 7);
+		g.insert_edge(2, 1, 4);
+		g.insert_edge(3, 2, 1);
+
+		auto completed = g.replace_node(2, 5);
+		CHECK(completed);
+		CHECK(g.weights(5, 5) == std::vector<int>{7});
+		CHECK(g.weights(5, 1) == std::vector<int>{4});
+		CHECK(g.weights(3, 5) == std::vector<int>{1});
+
+		// The incoming index must now refer to the new node.
+		CHECK(g.erase_node(5));
+		CHECK(g.begin() == g.end());
+	}
+
 	SECTION("src isnt a node") {
 		auto g = gdwg::graph<int, int>();
 		CHECK(g.empty());
@@ -433,6 +729,32 @@ TEST_CASE("merge_replace_node") {
 		CHECK(w2[1] == 99);
 	}
 
+	SECTION("merging nodes with self-loops and shared edges") {
+		auto g = gdwg::graph<int, int>{1, 2, 3};
+		g.insert_edge(1, 1, 4);
+		g.insert_edge(1, 2, 6);
+		g.insert_edge(2, 1, 6);
+		g.insert_edge(2, 2, 6);
+		g.insert_edge(3, 1, 8);
+
+		g.merge_replace_node(1, 2);
+		CHECK(!g.is_node(1));
+		CHECK(g.weights(2, 2) == std::vector<int>{4, 6});
+		CHECK(g.weights(3, 2) == std::vector<int>{8});
+		CHECK(g.connections(2) == std::vector<int>{2});
+
+		CHECK(g.erase_node(2));
+		CHECK(g.begin() == g.end());
+	}
+
+	SECTION("merging a node into itself") {
+		auto g = gdwg::graph<int, int>{1, 2};
+		g.insert_edge(1, 2, 3);
+		g.merge_replace_node(1, 1);
+		CHECK(g.is_node(1));
+		CHECK(g.weights(1, 2) == std::vector<int>{3});
+	}
+
 	SECTION("new data node does not exist") {
 		auto g = gdwg::graph<int, int>();
 		CHECK(g.empty());
@@ -533,6 +855,28 @@ TEST_CASE("erase_node") {
 		CHECK(iter2 == g.end());
 	}
 
+	SECTION("erase node with incoming edges from many sources and a self-loop") {
+		auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+		g.insert_edge(1, 2, 10);
+		g.insert_edge(3, 2, 30);
+		g.insert_edge(3, 1, 5);
+		g.insert_edge(2, 2, 1);
+		g.insert_edge(2, 4, 2);
+		g.insert_edge(4, 2, 9);
+		CHECK(g.erase_node(2));
+
+		auto iter = g.begin();
+		CHECK((*iter).from == 3);
+		CHECK((*iter).to == 1);
+		CHECK((*iter).weight == 5);
+		CHECK(++iter == g.end());
+		CHECK(g.connections(1).empty());
+		CHECK(g.connections(4).empty());
+
+		CHECK(g.erase_node(1));
+		CHECK(g.begin() == g.end());
+	}
+
 	SECTION("non exist node") {
 		auto g = gdwg::graph<int, int>();
 		CHECK(g.empty());
@@ -759,3 +1103,621 @@ TEST_CASE("erase_edge(iterator, iterator)") {
 		CHECK(g.find(3, 2, 1220) == g.end());
 	}
 }
+
+TEST_CASE("erase_edges_if") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b", 5);
+	g.insert_edge("a", "c", 2);
+	g.insert_edge("b", "a", 3);
+	g.insert_edge("c", "c", 7);
+	g.insert_edge("d", "a", 4);
+
+	SECTION("erases matching edges only") {
+		CHECK(g.erase_edges_if([](auto const&, auto const&, int weight) { return weight < 4; }) == 3);
+		CHECK(g.num_edges() == 3);
+		CHECK(g.weights("a", "b") == std::vector<int>{5});
+		CHECK(!g.is_connected("a", "c"));
+		CHECK(!g.is_connected("b", "a"));
+		CHECK(g.connections("b").empty());
+		CHECK(g.out_degree("a") == 1);
+		CHECK(g.in_degree("a") == 1);
+		CHECK(g.in_degree("c") == 1);
+		CHECK((*g.begin()).weight == 5);
+	}
+
+	SECTION("keeps the incoming index in step") {
+		g.erase_edges_if(
+		   [](std::string const& from, std::string const&, int) { return from == "a"; });
+		g.merge_replace_node("b", "c");
+		CHECK(g.weights("c", "a") == std::vector<int>{3});
+		CHECK(g.erase_node("a"));
+		CHECK(g.num_edges() == 1);
+		CHECK(g.weights("c", "c") == std::vector<int>{7});
+	}
+
+	SECTION("erasing everything and nothing") {
+		CHECK(g.erase_edges_if([](auto const&, auto const&, auto const&) { return false; }) == 0);
+		CHECK(g.num_edges() == 6);
+		CHECK(g.erase_edges_if([](auto const&, auto const&, auto const&) { return true; }) == 6);
+		CHECK(g.begin() == g.end());
+		CHECK(g.num_nodes() == 4);
+		CHECK(g.in_degree("a") == 0);
+	}
+
+	SECTION("a throwing predicate leaves the graph consistent") {
+		CHECK_THROWS(g.erase_edges_if([](std::string const& from, std::string const& to, int) {
+			if (from == "c") {
+				throw std::runtime_error("stop");
+			}
+			return to == "b";
+		}));
+		CHECK(g.num_edges() == 4);
+		CHECK(g.connections("a") == std::vector<std::string>{"c"});
+		CHECK(g.in_degree("b") == 0);
+		CHECK(g.erase_node("b"));
+		CHECK(g.num_edges() == 3);
+	}
+}
+
+namespace {
+	// The batched modifiers sweep every edge when the nodes they are given hold a large share of
+	// them, as in the small graphs of these tests, and otherwise walk only those nodes' own edges.
+	// This grows g by a tail of nodes, each with an edge to the node at half its index, so that a
+	// batch applied to a few of them takes the second path, and checks it against the same change
+	// made one node at a time, counters included, as operator== does not compare those.
+	template<typename G, typename MakeNode, typename Batch, typename OneByOne>
+	auto check_on_large_graph(G& g,
+	                          MakeNode make_node,
+	                          std::size_t changed,
+	                          Batch batch,
+	                          OneByOne one_by_one) -> void {
+		for (auto i = 0; i < 200; i++) {
+			g.insert_node(make_node(i));
+			g.insert_edge(make_node(i), make_node(i / 2), i);
+		}
+		auto expected = g;
+		one_by_one(expected);
+		CHECK(batch(g) == changed);
+		CHECK(g == expected);
+		CHECK(g.num_edges() == expected.num_edges());
+		for (auto const& node : expected.nodes()) {
+			CHECK(g.out_degree(node) == expected.out_degree(node));
+			CHECK(g.in_degree(node) == expected.in_degree(node));
+		}
+	}
+} // namespace
+
+TEST_CASE("erase_nodes_if") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4, 5, 6};
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(2, 3, 2);
+	g.insert_edge(3, 1, 3);
+	g.insert_edge(4, 4, 4);
+	g.insert_edge(5, 2, 5);
+	g.insert_edge(2, 2, 6);
+
+	SECTION("erases the nodes and their edges") {
+		CHECK(g.erase_nodes_if([](int node) { return node % 2 == 0; }) == 3);
+		CHECK(g.nodes() == std::vector<int>{1, 3, 5});
+		CHECK(g.num_edges() == 1);
+		CHECK(g.weights(3, 1) == std::vector<int>{3});
+		CHECK(g.out_degree(1) == 0);
+		CHECK(g.out_degree(5) == 0);
+		CHECK(g.in_degree(1) == 1);
+		CHECK(g.connections(5).empty());
+	}
+
+	SECTION("erased ids are reused") {
+		g.erase_nodes_if([](int node) { return node > 3; });
+		CHECK(g.insert_node(7));
+		CHECK(g.insert_node(0));
+		g.insert_edge(7, 0, 1);
+		g.insert_edge(0, 7, 2);
+		CHECK(g.freeze().nodes() == std::vector<int>{0, 1, 2, 3, 7});
+		CHECK(g.weights(0, 7) == std::vector<int>{2});
+		CHECK(g.num_edges() == 6);
+	}
+
+	SECTION("erasing nothing and everything") {
+		CHECK(g.erase_nodes_if([](int) { return false; }) == 0);
+		CHECK(g.num_nodes() == 6);
+		CHECK(g.erase_nodes_if([](int) { return true; }) == 6);
+		CHECK(g.empty());
+		CHECK(g.num_edges() == 0);
+		CHECK(g.begin() == g.end());
+	}
+
+	SECTION("a few nodes of a large graph") {
+		check_on_large_graph(
+		   g,
+		   [](int i) { return i; },
+		   2,
+		   [](auto& big) {
+			   return big.erase_nodes_if([](int node) { return node == 50 || node == 100; });
+		   },
+		   [](auto& big) {
+			   big.erase_node(50);
+			   big.erase_node(100);
+		   });
+	}
+}
+
+TEST_CASE("erase_nodes") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 2);
+	g.insert_edge("c", "a", 3);
+	g.insert_edge("d", "d", 4);
+	g.insert_edge("e", "b", 5);
+	g.insert_edge("a", "e", 6);
+
+	SECTION("iterator pair") {
+		auto const victims = std::vector<std::string>{"b", "d"};
+		CHECK(g.erase_nodes(victims.begin(), victims.end()) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "c", "e"});
+		CHECK(g.num_edges() == 2);
+		CHECK(g.connections("a") == std::vector<std::string>{"e"});
+		CHECK(g.connections("e").empty());
+		CHECK(g.in_degree("e") == 1);
+		CHECK(g.out_degree("c") == 1);
+	}
+
+	SECTION("range with missing and repeated nodes") {
+		auto const victims = std::vector<std::string_view>{"e", "z", "a", "e"};
+		CHECK(g.erase_nodes(victims) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "c", "d"});
+		CHECK(g.weights("b", "c") == std::vector<int>{2});
+		CHECK(g.weights("d", "d") == std::vector<int>{4});
+		CHECK(g.num_edges() == 2);
+		CHECK(g.in_degree("b") == 0);
+	}
+
+	SECTION("no victims") {
+		CHECK(g.erase_nodes(std::vector<std::string>{}) == 0);
+		CHECK(g.erase_nodes(std::vector<std::string>{"x"}) == 0);
+		CHECK(g.num_nodes() == 5);
+		CHECK(g.num_edges() == 6);
+	}
+
+	SECTION("every node") {
+		CHECK(g.erase_nodes(g.nodes()) == 5);
+		CHECK(g.empty());
+		CHECK(g.begin() == g.end());
+		CHECK(g.insert_node("f"));
+		CHECK(g.insert_edge("f", "f", 1));
+	}
+
+	SECTION("a few nodes of a large graph") {
+		check_on_large_graph(
+		   g,
+		   [](int i) { return "n" + std::to_string(i); },
+		   3,
+		   [](auto& big) {
+			   return big.erase_nodes(std::vector<std::string>{"n150", "n6", "n5", "n6"});
+		   },
+		   [](auto& big) {
+			   for (auto const* victim : {"n5", "n6", "n150"}) {
+				   big.erase_node(victim);
+			   }
+		   });
+		CHECK(g.insert_node("n6"));
+		CHECK(g.insert_edge("n4", "n6", 3));
+		CHECK(g.in_degree("n6") == 1);
+	}
+}
+
+TEST_CASE("relabel") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 2);
+	g.insert_edge("c", "a", 3);
+	g.insert_edge("a", "a", 4);
+	g.insert_edge("d", "b", 5);
+
+	SECTION("renames to new values") {
+		auto const a = g.handle("a");
+		CHECK(g.relabel(std::map<std::string, std::string>{{"a", "x"}, {"c", "y"}}) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "d", "x", "y"});
+		CHECK(g.weights("x", "b") == std::vector<int>{1});
+		CHECK(g.weights("b", "y") == std::vector<int>{2});
+		CHECK(g.weights("y", "x") == std::vector<int>{3});
+		CHECK(g.weights("x", "x") == std::vector<int>{4});
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree("x") == 2);
+		CHECK(g.in_degree("x") == 2);
+		CHECK(g.handle("x") == a);
+		CHECK(g.connections("d") == std::vector<std::string>{"b"});
+	}
+
+	SECTION("renames are simultaneous") {
+		CHECK(g.relabel(std::map<std::string, std::string>{{"a", "b"}, {"b", "a"}}) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(g.weights("b", "a") == std::vector<int>{1});
+		CHECK(g.weights("a", "c") == std::vector<int>{2});
+		CHECK(g.weights("c", "b") == std::vector<int>{3});
+		CHECK(g.weights("b", "b") == std::vector<int>{4});
+		CHECK(g.weights("d", "a") == std::vector<int>{5});
+	}
+
+	SECTION("collisions merge") {
+		g.insert_edge("c", "b", 1);
+		CHECK(g.relabel(std::map<std::string, std::string>{{"a", "c"}, {"d", "c"}}) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "c"});
+		CHECK(g.weights("c", "b") == std::vector<int>{1, 5});
+		CHECK(g.weights("b", "c") == std::vector<int>{2});
+		CHECK(g.weights("c", "c") == std::vector<int>{3, 4});
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree("c") == 4);
+		CHECK(g.in_degree("b") == 2);
+		CHECK(!g.handle("a"));
+		CHECK(g.insert_node("e"));
+		CHECK(g.insert_node("f"));
+		CHECK(g.insert_edge("e", "f", 6));
+	}
+
+	SECTION("missing, repeated and unchanged keys") {
+		auto const mapping = std::vector<std::pair<std::string_view, std::string>>{
+		   {"z", "q"},
+		   {"b", "b"},
+		   {"d", "e"},
+		   {"d", "f"},
+		};
+		CHECK(g.relabel(mapping) == 1);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c", "e"});
+		CHECK(g.weights("e", "b") == std::vector<int>{5});
+		CHECK(g.relabel(std::vector<std::pair<std::string, std::string>>{{"b", "b"}, {"b", "q"}})
+		      == 0);
+		CHECK(g.is_node("b"));
+	}
+
+	SECTION("one node of a large graph") {
+		auto const n7 = g.emplace_node("n7").first;
+		check_on_large_graph(
+		   g,
+		   [](int i) { return "n" + std::to_string(i); },
+		   2,
+		   [](auto& big) {
+			   return big.relabel(std::map<std::string, std::string>{{"n7", "m"}, {"b", "n7"}});
+		   },
+		   [](auto& big) {
+			   CHECK(big.replace_node("n7", "m"));
+			   CHECK(big.replace_node("b", "n7"));
+		   });
+		CHECK(g.handle("m") == n7);
+		CHECK(g.weights("n7", "c") == std::vector<int>{2});
+	}
+
+	SECTION("function") {
+		CHECK(g.relabel([](std::string const& node) { return node == "d" ? node : node + "1"; })
+		      == 3);
+		CHECK(g.nodes() == std::vector<std::string>{"a1", "b1", "c1", "d"});
+		CHECK(g.weights("c1", "a1") == std::vector<int>{3});
+		CHECK(g.weights("d", "b1") == std::vector<int>{5});
+		CHECK(g.relabel([](std::string const&) { return std::string("n"); }) == 4);
+		CHECK(g.nodes() == std::vector<std::string>{"n"});
+		CHECK(g.weights("n", "n") == std::vector<int>{1, 2, 3, 4, 5});
+		CHECK(g.in_degree("n") == 5);
+	}
+
+	SECTION("a throwing function leaves the graph unchanged") {
+		auto const copy = g;
+		CHECK_THROWS_AS(g.relabel([](std::string const& node) -> std::string {
+			if (node == "c") {
+				throw std::runtime_error("c");
+			}
+			return node + "1";
+		}),
+		                std::runtime_error);
+		CHECK(g == copy);
+	}
+}
+
+TEST_CASE("merge_replace_nodes") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 2);
+	g.insert_edge("c", "a", 3);
+	g.insert_edge("d", "a", 1);
+	g.insert_edge("d", "b", 1);
+	g.insert_edge("e", "e", 4);
+
+	SECTION("matches repeated merge_replace_node") {
+		auto expected = g;
+		expected.merge_replace_node("a", "b");
+		expected.merge_replace_node("e", "d");
+		CHECK(g.merge_replace_nodes(std::map<std::string, std::string>{{"a", "b"}, {"e", "d"}})
+		      == 2);
+		CHECK(g == expected);
+		CHECK(g.weights("d", "b") == std::vector<int>{1});
+		CHECK(g.weights("b", "b") == std::vector<int>{1});
+		CHECK(g.weights("d", "d") == std::vector<int>{4});
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree("d") == 2);
+		CHECK(g.in_degree("b") == 3);
+	}
+
+	SECTION("chains") {
+		auto const pairs = std::vector<std::pair<std::string_view, std::string_view>>{
+		   {"a", "b"},
+		   {"b", "c"},
+		   {"a", "d"},
+		};
+		CHECK(g.merge_replace_nodes(pairs) == 3);
+		CHECK(g.nodes() == std::vector<std::string>{"d", "e"});
+		CHECK(g.weights("d", "d") == std::vector<int>{1, 2, 3});
+		CHECK(g.num_edges() == 4);
+		CHECK(g.in_degree("d") == 3);
+		CHECK(g.insert_node("f"));
+		CHECK(g.insert_edge("f", "d", 5));
+	}
+
+	SECTION("cycles and repeats") {
+		auto const pairs = std::vector<std::pair<std::string, std::string>>{
+		   {"a", "b"},
+		   {"b", "a"},
+		   {"a", "b"},
+		   {"c", "c"},
+		};
+		CHECK(g.merge_replace_nodes(pairs) == 1);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "c", "d", "e"});
+		CHECK(g.weights("c", "b") == std::vector<int>{3});
+	}
+
+	SECTION("a few nodes of a large graph") {
+		check_on_large_graph(
+		   g,
+		   [](int i) { return "n" + std::to_string(i); },
+		   2,
+		   [](auto& big) {
+			   return big.merge_replace_nodes(
+			      std::vector<std::pair<std::string, std::string>>{{"n9", "n1"}, {"n1", "c"}});
+		   },
+		   [](auto& big) {
+			   big.merge_replace_node("n9", "n1");
+			   big.merge_replace_node("n1", "c");
+		   });
+		CHECK(g.weights("c", "n4") == std::vector<int>{9});
+	}
+
+	SECTION("missing nodes change nothing") {
+		auto const copy = g;
+		auto const pairs = std::vector<std::pair<std::string, std::string>>{
+		   {"a", "b"},
+		   {"c", "z"},
+		};
+		CHECK_THROWS_WITH(g.merge_replace_nodes(pairs),
+		                  "Cannot call gdwg::graph<N, E>::merge_replace_nodes on old or new data if "
+		                  "they don't exist in the graph");
+		CHECK(g == copy);
+		CHECK(g.merge_replace_nodes(std::vector<std::pair<std::string, std::string>>{}) == 0);
+	}
+}
+
+TEST_CASE("update_weight") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "c", 3);
+
+	CHECK(g.update_weight("a", "b", 1, 5));
+	CHECK(g.weights("a", "b") == std::vector<int>{2, 5});
+	CHECK(g.update_weight("a", "b", 5, 5));
+	CHECK(!g.update_weight("a", "b", 5, 2));
+	CHECK(!g.update_weight("a", "b", 1, 7));
+	CHECK(!g.update_weight("b", "a", 2, 7));
+	CHECK(g.weights("a", "b") == std::vector<int>{2, 5});
+	CHECK(g.update_weight(g.handle("a"), g.handle("c"), 3, 0));
+	CHECK(g.weights("a", "c") == std::vector<int>{0});
+	CHECK(g.num_edges() == 3);
+	CHECK(g.out_degree("a") == 3);
+	CHECK_THROWS_WITH(g.update_weight("a", "d", 1, 2),
+	                  "Cannot call gdwg::graph<N, E>::update_weight on src or dst if they don't "
+	                  "exist in the graph");
+	CHECK_THROWS_WITH(g.update_weight(g.handle("d"), g.handle("a"), 1, 2),
+	                  "Cannot call gdwg::graph<N, E>::update_weight on src or dst if they don't "
+	                  "exist in the graph");
+
+	SECTION("reuses the edge's memory") {
+		auto resource = counting_resource();
+		auto h = gdwg::pmr::graph<int, int>({1, 2}, &resource);
+		h.insert_edge(1, 2, 0);
+		h.insert_edge(1, 2, 100);
+		auto const allocations = resource.allocations();
+		for (auto weight = 1; weight < 50; weight++) {
+			CHECK(h.update_weight(1, 2, weight - 1, weight));
+		}
+		auto edge = h.extract_edge(1, 2, 100);
+		edge.weight() = 0;
+		CHECK(h.insert_edge(std::move(edge)));
+		CHECK(h.weights(1, 2) == std::vector<int>{0, 49});
+		CHECK(resource.allocations() == allocations);
+	}
+}
+
+TEST_CASE("extract_edge and insert_edge(extracted_edge&&)") {
+	auto g = gdwg::graph<std::string, std::string>{"a", "b", "c"};
+	g.insert_edge("a", "b", "x");
+	g.insert_edge("a", "b", "y");
+	g.insert_edge("b", "c", "z");
+
+	SECTION("round trip with a new weight") {
+		auto edge = g.extract_edge("a", "b", "x");
+		REQUIRE(edge);
+		CHECK(edge.from() == "a");
+		CHECK(edge.to() == "b");
+		CHECK(edge.weight() == "x");
+		CHECK(g.weights("a", "b") == std::vector<std::string>{"y"});
+		CHECK(g.num_edges() == 2);
+		CHECK(g.in_degree("b") == 1);
+
+		edge.weight() = "w";
+		CHECK(g.insert_edge(std::move(edge)));
+		CHECK(!edge);
+		CHECK(g.weights("a", "b") == std::vector<std::string>{"w", "y"});
+		CHECK(g.num_edges() == 3);
+		CHECK(g.in_degree("b") == 2);
+	}
+
+	SECTION("last edge of a node") {
+		auto edge = g.extract_edge(g.find("b", "c", "z"));
+		CHECK(g.connections("b").empty());
+		CHECK(g.in_degree("c") == 0);
+		CHECK(g.begin() != g.end());
+		CHECK(g.insert_edge(std::move(edge)));
+		CHECK(g.is_connected("b", "c"));
+	}
+
+	SECTION("duplicates are handed back") {
+		auto edge = g.extract_edge("a", "b", "x");
+		CHECK(g.insert_edge("a", "b", "x"));
+		CHECK(!g.insert_edge(std::move(edge)));
+		REQUIRE(edge);
+		CHECK(edge.to() == "b");
+		CHECK(g.num_edges() == 3);
+	}
+
+	SECTION("into another graph") {
+		auto other = gdwg::graph<std::string, std::string>{"a", "b"};
+		auto edge = g.extract_edge("a", "b", "y");
+		CHECK(other.insert_edge(std::move(edge)));
+		CHECK(other.weights("a", "b") == std::vector<std::string>{"y"});
+		CHECK(other.in_degree("b") == 1);
+		CHECK(g.weights("a", "b") == std::vector<std::string>{"x"});
+
+		auto missing = g.extract_edge("b", "c", "z");
+		CHECK_THROWS_WITH(other.insert_edge(std::move(missing)),
+		                  "Cannot call gdwg::graph<N, E>::insert_edge when either src or dst node "
+		                  "does not exist");
+		CHECK(missing.weight() == "z");
+	}
+
+	SECTION("into a graph with another memory resource") {
+		auto resource_1 = std::pmr::monotonic_buffer_resource{};
+		auto resource_2 = std::pmr::monotonic_buffer_resource{};
+		auto g1 = gdwg::pmr::graph<int, int>({1, 2}, &resource_1);
+		auto g2 = gdwg::pmr::graph<int, int>({1, 2}, &resource_2);
+		g1.insert_edge(1, 2, 3);
+		CHECK(g2.insert_edge(g1.extract_edge(1, 2, 3)));
+		CHECK(g2.weights(1, 2) == std::vector<int>{3});
+		CHECK(g1.num_edges() == 0);
+	}
+
+	SECTION("edges that do not exist") {
+		CHECK(!g.extract_edge("c", "a", "x"));
+		CHECK(!g.insert_edge(gdwg::graph<std::string, std::string>::extracted_edge()));
+		CHECK_THROWS_WITH(g.extract_edge("a", "d", "x"),
+		                  "Cannot call gdwg::graph<N, E>::extract_edge on src or dst if they don't "
+		                  "exist in the graph");
+	}
+}
+
+TEST_CASE("merge") {
+	auto g = gdwg::graph<std::string, int>{"a", "c", "e"};
+	g.insert_edge("a", "c", 1);
+	g.insert_edge("c", "e", 2);
+	auto other = gdwg::graph<std::string, int>{"b", "c", "d", "e"};
+	other.insert_edge("c", "e", 2);
+	other.insert_edge("c", "e", 3);
+	other.insert_edge("b", "c", 4);
+	other.insert_edge("d", "d", 5);
+	other.insert_edge("e", "b", 6);
+
+	SECTION("moves what is missing and leaves what collides") {
+		auto const b = other.handle("b");
+		g.merge(other);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c", "d", "e"});
+		CHECK(g.weights("c", "e") == std::vector<int>{2, 3});
+		CHECK(g.weights("b", "c") == std::vector<int>{4});
+		CHECK(g.weights("d", "d") == std::vector<int>{5});
+		CHECK(g.weights("e", "b") == std::vector<int>{6});
+		CHECK(g.num_edges() == 6);
+		CHECK(g.out_degree("c") == 2);
+		CHECK(g.in_degree("c") == 2);
+		CHECK(g.in_degree("b") == 1);
+		CHECK(g.handle("b") == b);
+		CHECK(g.connections("e") == std::vector<std::string>{"b"});
+
+		CHECK(other.nodes() == std::vector<std::string>{"c", "e"});
+		CHECK(other.weights("c", "e") == std::vector<int>{2});
+		CHECK(other.num_edges() == 1);
+		CHECK(other.in_degree("e") == 1);
+		CHECK(other.out_degree("e") == 0);
+		CHECK(other.insert_node("f"));
+		CHECK(other.insert_edge("f", "c", 7));
+		CHECK(g.insert_node("g"));
+		CHECK(g.insert_edge("g", "a", 8));
+	}
+
+	SECTION("into an empty graph") {
+		auto const expected = other;
+		auto empty = gdwg::graph<std::string, int>();
+		empty.merge(std::move(other));
+		CHECK(empty == expected);
+		CHECK(other.empty());
+	}
+
+	SECTION("with itself") {
+		auto const expected = g;
+		g.merge(g);
+		CHECK(g == expected);
+	}
+
+	SECTION("relinks rather than allocates") {
+		auto resource = counting_resource();
+		auto g1 = gdwg::pmr::graph<int, int>({1, 3}, &resource);
+		auto g2 = gdwg::pmr::graph<int, int>({2, 3, 4}, &resource);
+		g1.insert_edge(1, 3, 0);
+		g2.insert_edge(2, 3, 1);
+		g2.insert_edge(3, 4, 2);
+		g2.insert_edge(4, 2, 3);
+		auto const allocations = resource.allocations();
+		g1.merge(g2);
+		// Only other's list of free ids grows.
+		CHECK(resource.allocations() <= allocations + 1);
+		CHECK(g1.num_edges() == 4);
+		CHECK(g1.weights(4, 2) == std::vector<int>{3});
+		CHECK(g2.nodes() == std::vector<int>{3});
+	}
+
+	SECTION("relinks edge sets that are trees under flat_storage") {
+		auto resource = counting_resource();
+		auto g1 = gdwg::pmr::graph<int, int, gdwg::flat_storage<2>>({0, 3, 4}, &resource);
+		auto g2 = gdwg::pmr::graph<int, int, gdwg::flat_storage<2>>({1, 2, 3, 4}, &resource);
+		for (auto weight = 0; weight < 6; weight++) {
+			g2.insert_edge(1, weight % 2 + 2, weight);
+		}
+		// Every edge from 3 is already in g1, so g2's tree of them is left alone.
+		for (auto weight = 0; weight < 3; weight++) {
+			g1.insert_edge(3, 4, weight);
+			g2.insert_edge(3, 4, weight);
+		}
+		auto const allocations = resource.allocations();
+		g1.merge(g2);
+		// Only other's list of free ids grows.
+		CHECK(resource.allocations() <= allocations + 1);
+		CHECK(g1.weights(1, 3) == std::vector<int>{1, 3, 5});
+		CHECK(g1.out_degree(1) == 6);
+		CHECK(g2.nodes() == std::vector<int>{3, 4});
+		CHECK(g2.weights(3, 4) == std::vector<int>{0, 1, 2});
+		CHECK(g1.insert_edge(1, 0, 7));
+		CHECK(g1.erase_edge(1, 2, 0));
+		CHECK(g1.out_degree(1) == 6);
+	}
+
+	SECTION("with another memory resource") {
+		auto resource_1 = std::pmr::monotonic_buffer_resource{};
+		auto resource_2 = std::pmr::monotonic_buffer_resource{};
+		auto g1 = gdwg::pmr::graph<int, int>({1, 3}, &resource_1);
+		auto g2 = gdwg::pmr::graph<int, int>({2, 3}, &resource_2);
+		g1.insert_edge(1, 3, 0);
+		g2.insert_edge(2, 3, 1);
+		g2.insert_edge(3, 3, 2);
+		g1.merge(g2);
+		CHECK(g1.nodes() == std::vector<int>{1, 2, 3});
+		CHECK(g1.weights(3, 3) == std::vector<int>{2});
+		CHECK(g2.nodes() == std::vector<int>{3});
+		CHECK(g2.begin() == g2.end());
+		CHECK(g2.get_allocator().resource() == &resource_2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "gdwg/shortest_paths.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+	// Distances by repeatedly relaxing every edge, to check shortest_paths against.
+	template<typename G, typename N>
+	auto reference_distances(G const& g, N const& src) -> auto {
+		using E = std::remove_cvref_t<decltype((*g.begin()).weight)>;
+		auto distances = std::map<N, E>{{src, E{}}};
+		auto changed = true;
+		while (changed) {
+			changed = false;
+			for (auto const& [from, to, weight] : g) {
+				auto const from_search = distances.find(from);
+				if (from_search == distances.end()) {
+					continue;
+				}
+				auto const candidate = from_search->second + weight;
+				auto const [to_search, inserted] = distances.emplace(to, candidate);
+				if (!inserted && candidate < to_search->second) {
+					to_search->second = candidate;
+					changed = true;
+				}
+				changed = changed || inserted;
+			}
+		}
+		return distances;
+	}
+
+	// Whether path follows edges of g and its lightest weights add up to distance.
+	template<typename G, typename N, typename E>
+	auto is_path_of_length(G const& g, std::vector<N> const& path, E distance) -> bool {
+		auto length = E{};
+		for (auto i = std::size_t{1}; i < path.size(); i++) {
+			auto const weights = g.weights(path[i - 1], path[i]);
+			if (weights.empty()) {
+				return false;
+			}
+			length += *std::min_element(weights.begin(), weights.end());
+		}
+		return length == distance;
+	}
+
+	auto make_random_graph(int num_nodes, int num_edges) -> gdwg::graph<int, int> {
+		auto engine = std::mt19937(42);
+		auto node_dist = std::uniform_int_distribution<int>(0, num_nodes - 1);
+		auto weight_dist = std::uniform_int_distribution<int>(0, 99);
+		auto g = gdwg::graph<int, int>();
+		for (auto i = 0; i < num_nodes; i++) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i < num_edges; i++) {
+			auto const from = node_dist(engine);
+			auto const to = node_dist(engine);
+			g.insert_edge(from, to, weight_dist(engine));
+		}
+		return g;
+	}
+} // namespace
+
+TEMPLATE_TEST_CASE("shortest_paths",
+                   "",
+                   gdwg::binary_heap,
+                   gdwg::dary_heap<3>,
+                   gdwg::radix_heap,
+                   gdwg::pairing_heap) {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e", "f"};
+	g.insert_edge("a", "b", 7);
+	g.insert_edge("a", "b", 4);
+	g.insert_edge("a", "c", 1);
+	g.insert_edge("c", "b", 2);
+	g.insert_edge("b", "d", 5);
+	g.insert_edge("c", "d", 9);
+	g.insert_edge("d", "d", 0);
+	g.insert_edge("d", "a", 1);
+	g.insert_edge("f", "a", 1);
+
+	SECTION("distances and paths") {
+		auto const tree = gdwg::shortest_paths<TestType>(g, "a");
+		CHECK(tree.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(tree.distance("a") == 0);
+		CHECK(tree.distance("b") == 3);
+		CHECK(tree.distance("c") == 1);
+		CHECK(tree.distance("d") == 8);
+		CHECK(tree.path("d") == std::vector<std::string>{"a", "c", "b", "d"});
+		CHECK(tree.path("a") == std::vector<std::string>{"a"});
+	}
+
+	SECTION("unreached nodes have no distance or path") {
+		auto const tree = gdwg::shortest_paths<TestType>(g, "a");
+		CHECK(!tree.reached("e"));
+		CHECK(!tree.reached("f"));
+		CHECK(!tree.distance("e").has_value());
+		CHECK(tree.path("f").empty());
+		CHECK(!tree.reached("z"));
+		CHECK(tree.path("z").empty());
+
+		auto const isolated = gdwg::shortest_paths<TestType>(g, std::string_view("e"));
+		CHECK(isolated.nodes() == std::vector<std::string>{"e"});
+	}
+
+	SECTION("a frozen snapshot gives the same tree") {
+		auto const c = g.freeze();
+		for (auto const& node : g.nodes()) {
+			CHECK(gdwg::shortest_paths<TestType>(c, node) == gdwg::shortest_paths<TestType>(g, node));
+		}
+	}
+
+	SECTION("a target stops the search once it is settled") {
+		auto const tree = gdwg::shortest_paths<TestType>(g, "a", "b");
+		CHECK(tree.distance("b") == 3);
+		CHECK(tree.path("b") == std::vector<std::string>{"a", "c", "b"});
+		CHECK(!tree.reached("d"));
+		CHECK(tree.nodes() == std::vector<std::string>{"a", "b", "c"});
+
+		auto const c = g.freeze();
+		CHECK(gdwg::shortest_paths<TestType>(c, "a", "b") == tree);
+		CHECK(gdwg::shortest_paths<TestType>(g, "a", "a").nodes() == std::vector<std::string>{"a"});
+
+		// An unreachable target leaves the search to run to completion.
+		CHECK(gdwg::shortest_paths<TestType>(g, "a", "e") == gdwg::shortest_paths<TestType>(g, "a"));
+	}
+
+	SECTION("missing nodes throw") {
+		CHECK_THROWS_MATCHES(gdwg::shortest_paths<TestType>(g, "z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::shortest_paths if src "
+		                                              "doesn't exist in the graph"));
+		CHECK_THROWS_MATCHES(gdwg::shortest_paths<TestType>(g.freeze(), "a", "z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::shortest_paths if src or "
+		                                              "target don't exist in the graph"));
+	}
+
+	SECTION("negative weights throw") {
+		g.insert_edge("e", "c", -1);
+		CHECK_THROWS_MATCHES(gdwg::shortest_paths<TestType>(g, "e"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::shortest_paths on a graph "
+		                                              "with a negative weight"));
+		// The edge is never looked at if the search does not reach e.
+		CHECK(gdwg::shortest_paths<TestType>(g, "a").distance("d") == 8);
+	}
+
+	SECTION("random graph matches the reference") {
+		auto r = make_random_graph(300, 1500);
+		// Erasing nodes leaves gaps among the ids that the search indexes its arrays by.
+		for (auto i = 0; i < 300; i += 17) {
+			r.erase_node(i);
+		}
+		auto const c = r.freeze();
+		for (auto const src : {1, 50, 299}) {
+			auto const expected = reference_distances(r, src);
+			auto const tree = gdwg::shortest_paths<TestType>(r, src);
+			CHECK(tree == gdwg::shortest_paths<TestType>(c, src));
+			CHECK(tree.nodes().size() == expected.size());
+			for (auto const& [node, distance] : expected) {
+				CHECK(tree.distance(node) == distance);
+				CHECK(is_path_of_length(r, tree.path(node), distance));
+			}
+		}
+	}
+}
+
+TEMPLATE_TEST_CASE("shortest_paths with floating point weights",
+                   "",
+                   gdwg::binary_heap,
+                   gdwg::radix_heap,
+                   gdwg::pairing_heap) {
+	auto g = gdwg::graph<int, double>{1, 2, 3, 4};
+	g.insert_edge(1, 2, 0.5);
+	g.insert_edge(2, 3, 0.25);
+	g.insert_edge(1, 3, 1.0);
+	g.insert_edge(3, 4, 2.0);
+	g.insert_edge(1, 4, 2.75);
+
+	auto const tree = gdwg::shortest_paths<TestType>(g, 1);
+	CHECK(tree.distance(3) == 0.75);
+	CHECK(tree.distance(4) == 2.75);
+	CHECK(tree.path(3) == std::vector<int>{1, 2, 3});
+	// The tie is kept by whichever edge reached 4 first.
+	CHECK(tree.path(4) == std::vector<int>{1, 4});
+}
+
+TEST_CASE("shortest_paths over flat storage and unsigned weights") {
+	auto g = gdwg::graph<int, unsigned, std::allocator<std::byte>, gdwg::flat_storage<>>{1, 2, 3};
+	g.insert_edge(1, 2, 4u);
+	g.insert_edge(2, 3, 4u);
+	g.insert_edge(1, 3, 9u);
+
+	auto const tree = gdwg::shortest_paths(g, 1);
+	CHECK(tree.distance(3) == 8u);
+	CHECK(tree == gdwg::shortest_paths<gdwg::radix_heap>(g.freeze(), 1));
+}
\ No newline at end of file
@@ -0,0 +1,325 @@
+#include "gdwg/graph.hpp"
+
+#include "counting_resource.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+	// The kept counts have to match what walking the graph finds.
+	template<typename G>
+	auto check_counts(G const& g) -> void {
+		auto num_edges = std::size_t{0};
+		for (auto iter = g.begin(); iter != g.end(); iter++) {
+			num_edges++;
+		}
+		CHECK(g.num_edges() == num_edges);
+		for (auto const& node : g.nodes()) {
+			auto out_degree = std::size_t{0};
+			auto in_degree = std::size_t{0};
+			for (auto const& other : g.nodes()) {
+				out_degree += g.weights(node, other).size();
+				in_degree += g.weights(other, node).size();
+			}
+			CHECK(g.out_degree(node) == out_degree);
+			CHECK(g.in_degree(node) == in_degree);
+		}
+	}
+} // namespace
+
+// flat_storage<2> turns into a tree as soon as a node has a third edge, so every test below runs
+// through both of its representations.
+TEMPLATE_TEST_CASE("storage policies",
+                   "",
+                   gdwg::tree_storage,
+                   gdwg::flat_storage<>,
+                   gdwg::flat_storage<2>) {
+	using graph_t = gdwg::graph<std::string, int, std::allocator<std::byte>, TestType>;
+	auto g = graph_t{"a", "b", "c", "d"};
+	g.insert_edge("a", "c", 3);
+	g.insert_edge("a", "b", 2);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "d", 4);
+	g.insert_edge("b", "a", 5);
+	g.insert_edge("c", "c", 6);
+
+	SECTION("insert_edge and lookups") {
+		CHECK(!g.insert_edge("a", "b", 2));
+		CHECK(g.insert_edge("a", "a", 0));
+		CHECK(g.weights("a", "b") == std::vector<int>{1, 2});
+		CHECK(g.weights("c", "a").empty());
+		CHECK(g.is_connected("a", "d"));
+		CHECK(!g.is_connected("d", "a"));
+		CHECK(g.is_connected_many("a", std::vector<std::string>{"a", "b", "bb", "d"})
+		      == std::vector<bool>{true, true, false, true});
+		CHECK(g.connections("a") == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(g.find("a", "b", 2) != g.end());
+		CHECK(g.find("a", "b", 3) == g.end());
+		CHECK((*g.find("c", "c", 6)).weight == 6);
+	}
+
+	SECTION("range views") {
+		auto const weights = g.weights_view("a", "b");
+		CHECK(std::vector<int>(weights.begin(), weights.end()) == std::vector<int>{1, 2});
+		auto const dsts = g.connections_view("a");
+		CHECK(std::vector<std::string>(dsts.begin(), dsts.end()) == g.connections("a"));
+		auto count = 0;
+		for (auto const& [to, weight] : g.out_edges("a")) {
+			CHECK(g.find("a", to, weight) != g.end());
+			count++;
+		}
+		CHECK(count == 4);
+	}
+
+	SECTION("iteration order") {
+		auto expected = std::vector<std::tuple<std::string, std::string, int>>{
+		   {"a", "b", 1},
+		   {"a", "b", 2},
+		   {"a", "c", 3},
+		   {"a", "d", 4},
+		   {"b", "a", 5},
+		   {"c", "c", 6},
+		};
+		auto forwards = std::vector<std::tuple<std::string, std::string, int>>{};
+		for (auto const& [from, to, weight] : g) {
+			forwards.emplace_back(from, to, weight);
+		}
+		CHECK(forwards == expected);
+
+		auto backwards = std::vector<std::tuple<std::string, std::string, int>>{};
+		for (auto iter = g.end(); iter != g.begin();) {
+			--iter;
+			backwards.emplace(backwards.begin(), (*iter).from, (*iter).to, (*iter).weight);
+		}
+		CHECK(backwards == expected);
+	}
+
+	SECTION("erase_edge(iterator)") {
+		auto iter = g.erase_edge(g.find("a", "b", 2));
+		CHECK((*iter).to == "c");
+		iter = g.erase_edge(g.find("a", "d", 4));
+		CHECK((*iter).from == "b");
+		CHECK(g.weights("a", "b") == std::vector<int>{1});
+		CHECK(g.erase_edge(g.find("c", "c", 6)) == g.end());
+	}
+
+	SECTION("erase_edge(iterator, iterator) within one node") {
+		auto iter = g.erase_edge(g.find("a", "b", 2), g.find("a", "d", 4));
+		CHECK((*iter).from == "a");
+		CHECK((*iter).to == "d");
+		CHECK(g.connections("a") == std::vector<std::string>{"b", "d"});
+		g.replace_node("b", "e");
+		CHECK(g.weights("a", "e") == std::vector<int>{1});
+		check_counts(g);
+	}
+
+	SECTION("erase_edge(iterator, iterator) across nodes") {
+		auto iter = g.erase_edge(g.find("a", "c", 3), g.find("c", "c", 6));
+		CHECK((*iter).from == "c");
+		CHECK(g.connections("a") == std::vector<std::string>{"b"});
+		CHECK(g.connections("b").empty());
+		CHECK(g.erase_edge(g.begin(), g.end()) == g.end());
+		CHECK(g.begin() == g.end());
+		CHECK(g.erase_node("a"));
+		check_counts(g);
+	}
+
+	SECTION("node modifiers") {
+		CHECK(g.replace_node("a", "e"));
+		CHECK(g.weights("e", "b") == std::vector<int>{1, 2});
+		CHECK(g.weights("b", "e") == std::vector<int>{5});
+
+		g.merge_replace_node("c", "b");
+		CHECK(g.weights("e", "b") == std::vector<int>{1, 2, 3});
+		CHECK(g.weights("b", "b") == std::vector<int>{6});
+
+		CHECK(g.erase_node("b"));
+		CHECK(g.connections("e") == std::vector<std::string>{"d"});
+		check_counts(g);
+	}
+
+	SECTION("growing and shrinking a node") {
+		for (auto weight = 10; weight < 50; weight++) {
+			CHECK(g.insert_edge("d", "a", weight));
+		}
+		CHECK(g.weights("d", "a").size() == 40);
+		CHECK(!g.insert_edge("d", "a", 25));
+		for (auto weight = 10; weight < 50; weight += 2) {
+			CHECK(g.erase_edge("d", "a", weight));
+		}
+		CHECK(g.weights("d", "a").size() == 20);
+		g.erase_edge(g.find("d", "a", 11), g.end());
+		CHECK(!g.is_connected("d", "a"));
+		CHECK(g.insert_edge("d", "a", 1));
+		CHECK(g.weights("d", "a") == std::vector<int>{1});
+		check_counts(g);
+	}
+
+	SECTION("erase_edges_if and erase_nodes_if") {
+		for (auto weight = 10; weight < 20; weight++) {
+			g.insert_edge("d", "a", weight);
+		}
+		CHECK(g.erase_edges_if([](auto const&, auto const&, int weight) { return weight % 2 == 1; })
+		      == 8);
+		CHECK(g.weights("d", "a") == std::vector<int>{10, 12, 14, 16, 18});
+		CHECK(g.weights("a", "b") == std::vector<int>{2});
+		check_counts(g);
+		CHECK(g.erase_nodes_if([](std::string const& node) { return node == "a"; }) == 1);
+		CHECK(g.connections("d").empty());
+		CHECK(g.weights("c", "c") == std::vector<int>{6});
+		check_counts(g);
+	}
+
+	SECTION("erase_nodes") {
+		CHECK(g.erase_nodes(std::vector<std::string>{"c", "a", "e"}) == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "d"});
+		CHECK(g.begin() == g.end());
+		CHECK(g.insert_edge("d", "b", 7));
+		check_counts(g);
+	}
+
+	SECTION("relabel") {
+		CHECK(g.relabel(std::vector<std::pair<std::string, std::string>>{{"a", "e"}, {"c", "b"}})
+		      == 2);
+		CHECK(g.nodes() == std::vector<std::string>{"b", "d", "e"});
+		CHECK(g.weights("e", "b") == std::vector<int>{1, 2, 3});
+		CHECK(g.weights("b", "e") == std::vector<int>{5});
+		CHECK(g.weights("b", "b") == std::vector<int>{6});
+		CHECK(g.connections("e") == std::vector<std::string>{"b", "d"});
+		check_counts(g);
+	}
+
+	SECTION("merge_replace_nodes") {
+		auto expected = g;
+		expected.merge_replace_node("a", "b");
+		expected.merge_replace_node("b", "c");
+		CHECK(g.merge_replace_nodes(std::vector<std::pair<std::string, std::string>>{{"a", "b"},
+		                                                                             {"b", "c"}})
+		      == 2);
+		CHECK(g == expected);
+		CHECK(g.weights("c", "c") == std::vector<int>{1, 2, 3, 5, 6});
+		check_counts(g);
+	}
+
+	SECTION("update_weight and extract_edge") {
+		CHECK(g.update_weight("a", "b", 1, 7));
+		CHECK(g.weights("a", "b") == std::vector<int>{2, 7});
+		CHECK(!g.update_weight("a", "b", 2, 7));
+		CHECK((*std::next(g.begin())).weight == 7);
+
+		auto edge = g.extract_edge("a", "d", 4);
+		CHECK(g.connections("a") == std::vector<std::string>{"b", "c"});
+		edge.weight() = 0;
+		CHECK(g.insert_edge(std::move(edge)));
+		CHECK(g.weights("a", "d") == std::vector<int>{0});
+
+		auto other = graph_t{"a", "c"};
+		for (auto weight = 10; weight < 15; weight++) {
+			other.insert_edge("a", "c", weight);
+		}
+		CHECK(other.insert_edge(g.extract_edge("a", "c", 3)));
+		CHECK(other.weights("a", "c") == std::vector<int>{3, 10, 11, 12, 13, 14});
+		CHECK(g.insert_edge(other.extract_edge("a", "c", 12)));
+		CHECK(g.weights("a", "c") == std::vector<int>{12});
+		check_counts(g);
+		check_counts(other);
+	}
+
+	SECTION("merge") {
+		auto other = graph_t{"a", "b", "e"};
+		for (auto weight = 0; weight < 5; weight++) {
+			other.insert_edge("a", "b", weight);
+			other.insert_edge("e", "a", weight);
+		}
+		g.merge(other);
+		CHECK(g.weights("a", "b") == std::vector<int>{0, 1, 2, 3, 4});
+		CHECK(g.weights("e", "a") == std::vector<int>{0, 1, 2, 3, 4});
+		CHECK(g.connections("a") == std::vector<std::string>{"b", "c", "d"});
+		CHECK(other.nodes() == std::vector<std::string>{"a", "b"});
+		CHECK(other.weights("a", "b") == std::vector<int>{1, 2});
+		check_counts(g);
+		check_counts(other);
+	}
+
+	SECTION("insert_edges") {
+		auto const added = g.insert_edges(std::vector<typename graph_t::value_type>{
+		   {"a", "b", 0},
+		   {"a", "b", 1},
+		   {"a", "e", 2},
+		   {"e", "a", 3},
+		   {"a", "bb", 4},
+		});
+		CHECK(added == 4);
+		CHECK(g.weights("a", "b") == std::vector<int>{0, 1, 2});
+		CHECK(g.connections("a") == std::vector<std::string>{"b", "bb", "c", "d", "e"});
+		CHECK(g.erase_node("e"));
+		CHECK(g.connections("a") == std::vector<std::string>{"b", "bb", "c", "d"});
+		check_counts(g);
+	}
+
+	SECTION("copies compare equal across storage policies") {
+		auto copy = g;
+		CHECK(copy == g);
+		auto tree = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+		for (auto const& [from, to, weight] : g) {
+			tree.insert_edge(from, to, weight);
+		}
+		CHECK(tree.freeze() == g.freeze());
+	}
+}
+
+TEST_CASE("flat_graph and pmr::graph with flat storage") {
+	auto g1 = gdwg::flat_graph<int, int, 4>{1, 2, 3};
+	auto resource = std::pmr::monotonic_buffer_resource{};
+	auto g2 = gdwg::pmr::graph<int, int, gdwg::flat_storage<4>>({1, 2, 3}, &resource);
+	for (auto weight = 0; weight < 8; weight++) {
+		g1.insert_edge(weight % 3 + 1, 2, weight);
+		g2.insert_edge(weight % 3 + 1, 2, weight);
+	}
+	CHECK(g1.freeze() == g2.freeze());
+	CHECK(g2.get_allocator().resource() == &resource);
+}
+
+TEMPLATE_TEST_CASE("memory_usage matches the allocator",
+                   "",
+                   gdwg::tree_storage,
+                   gdwg::flat_storage<>,
+                   gdwg::flat_storage<2>) {
+	auto resource = counting_resource();
+	auto g = gdwg::pmr::graph<std::pmr::string, std::pmr::string, TestType>(&resource);
+	CHECK(g.memory_usage().total() == 0);
+
+	auto const long_name = std::string(40, 'n');
+	for (auto i = 0; i < 20; i++) {
+		auto const name = (i % 2 == 0 ? long_name : "n") + std::to_string(i);
+		g.insert_node(std::pmr::string(name.begin(), name.end()));
+	}
+	auto const nodes = g.nodes();
+	for (auto i = std::size_t{0}; i < nodes.size(); i++) {
+		for (auto j = std::size_t{0}; j < i % 5; j++) {
+			g.insert_edge(nodes[i], nodes[(i + j) % nodes.size()], std::pmr::string(j * 10, 'w'));
+		}
+	}
+	auto usage = g.memory_usage();
+	CHECK(usage.total() == resource.bytes_in_use());
+	CHECK(usage.node_values > 0);
+	CHECK(usage.edge_weights > 0);
+	CHECK(usage.edge_sets > 0);
+	CHECK(usage.in_edge_index > 0);
+
+	for (auto i = std::size_t{0}; i < nodes.size(); i += 3) {
+		g.erase_node(nodes[i]);
+	}
+	usage = g.memory_usage();
+	CHECK(usage.total() == resource.bytes_in_use());
+	CHECK(usage.free_ids > 0);
+
+	g.clear();
+	CHECK(g.memory_usage().total() == resource.bytes_in_use());
+}
\ No newline at end of file